@@ -46,13 +46,9 @@ namespace graphics {
 			glm::vec2 max = center + halfExtents;
 			return { min, max };
 		}
-		static AABB create(engine::Transform2D& transform) {
-			if (isAxisAligned(transform.rotation)) {
-				return AABB::create(transform.position, transform.scale / 2.f);
-			}
-			else {
-				return AABB::create(transform.position, transform.scale / 2.f , transform.getRotationDegrees());
-			}
+		// Cached in the transform, only recomputed after it changed
+		static AABB create(const engine::Transform2D& transform) {
+			return { transform.boundsMin(), transform.boundsMax() };
 		}
 		static bool intersects(AABB a, AABB b) {
 			return (a.min.x <= b.max.x && a.max.x >= b.min.x) &&
@@ -0,0 +1,118 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace engine {
+	namespace {
+		thread_local AllocationCounters t_counters;
+		std::atomic<uint64_t> s_allocations{ 0 };
+		std::atomic<uint64_t> s_frees{ 0 };
+		std::atomic<uint64_t> s_bytes{ 0 };
+	}
+
+	const AllocationCounters& AllocationTracker::threadCounters() {
+		return t_counters;
+	}
+
+	AllocationCounters AllocationTracker::totals() {
+		return AllocationCounters{ s_allocations.load(std::memory_order_relaxed), s_frees.load(std::memory_order_relaxed), s_bytes.load(std::memory_order_relaxed) };
+	}
+
+#ifdef ENABLE_ALLOC_TRACKING
+	namespace {
+		// Must not allocate itself, thread_local PODs and atomics only
+		void countAllocation(std::size_t size) {
+			t_counters.allocations++;
+			t_counters.bytes += size;
+			s_allocations.fetch_add(1, std::memory_order_relaxed);
+			s_bytes.fetch_add(size, std::memory_order_relaxed);
+		}
+
+		void countFree() {
+			t_counters.frees++;
+			s_frees.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void* trackedAlloc(std::size_t size) {
+			void* ptr = std::malloc(size == 0 ? 1 : size);
+			if (ptr != nullptr)
+				countAllocation(size);
+			return ptr;
+		}
+
+		void* trackedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+			const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+			void* ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+			// aligned_alloc wants the size to be a multiple of the alignment
+			void* ptr = std::aligned_alloc(align, ((size == 0 ? 1 : size) + align - 1) & ~(align - 1));
+#endif
+			if (ptr != nullptr)
+				countAllocation(size);
+			return ptr;
+		}
+
+		void trackedFree(void* ptr) {
+			if (ptr == nullptr)
+				return;
+			countFree();
+			std::free(ptr);
+		}
+
+		void trackedAlignedFree(void* ptr) {
+			if (ptr == nullptr)
+				return;
+			countFree();
+#if defined(_WIN32)
+			_aligned_free(ptr);
+#else
+			std::free(ptr);
+#endif
+		}
+	}
+#endif
+}
+
+#ifdef ENABLE_ALLOC_TRACKING
+void* operator new(std::size_t size) {
+	if (void* ptr = engine::trackedAlloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+	if (void* ptr = engine::trackedAlloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return engine::trackedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return engine::trackedAlloc(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	if (void* ptr = engine::trackedAlignedAlloc(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	if (void* ptr = engine::trackedAlignedAlloc(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return engine::trackedAlignedAlloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return engine::trackedAlignedAlloc(size, alignment); }
+
+void operator delete(void* ptr) noexcept { engine::trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { engine::trackedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { engine::trackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { engine::trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { engine::trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { engine::trackedFree(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { engine::trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { engine::trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { engine::trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { engine::trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { engine::trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { engine::trackedAlignedFree(ptr); }
+#endif
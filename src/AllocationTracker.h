@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+namespace engine {
+	struct AllocationCounters {
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+		uint64_t bytes = 0;
+	};
+
+	// Counts every global operator new/delete. The operators are only replaced when the
+	// engine is built with ENABLE_ALLOC_TRACKING, otherwise all counters stay zero.
+	class AllocationTracker {
+	public:
+#ifdef ENABLE_ALLOC_TRACKING
+		static constexpr bool k_enabled = true;
+#else
+		static constexpr bool k_enabled = false;
+#endif
+
+		// Counters of the calling thread, used to attribute allocations to profiler zones
+		static const AllocationCounters& threadCounters();
+		// Sum over all threads since startup
+		static AllocationCounters totals();
+	};
+}
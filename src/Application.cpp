@@ -5,6 +5,8 @@
 #include "Window.h"
 #include "Experimental/CameraSystem.h"
 #include "Utils/keygen.h"
+#include "SaveSystem.h"
+#include "InputRecorder.h"
 #include <psapi.h>
 
 
@@ -97,9 +99,11 @@ namespace engine {
 	}
 
 	Application::Application(Window& window) : m_window{ window } {
+		// Before ImGui, its GLFW backend chains to the callbacks installed here
+		Input::init(m_window.glfwWindow());
 		initImGUI();
 		m_renderSystem.init();
-		Input::s_window = m_window.glfwWindow();
+		Profiler::Get().SetThreadName("Main");
 	}
 
 	void Application::initImGUI() {
@@ -118,8 +122,13 @@ namespace engine {
 	}
 
 	Application::~Application() {
+		SaveSystem::waitForCompletion();
+		InputRecorder::stopRecording();
+		Profiler::Get().DumpHistograms("profile_histograms.json");
 		destroyImGUI();
 		m_renderSystem.destroy();
+		// Flush what is still queued to the log file
+		DebugWindow::shutdown();
 	}
 
 	void Application::run() {
@@ -131,22 +140,28 @@ namespace engine {
 		timeBeginPeriod(1);
 
 		float timeScale = 1.f;
+		auto nextMemorySample = std::chrono::steady_clock::now();
 
 		while (!m_window.shouldClose()) {
 			Profiler::Get().BeginFrame();
 
-			SET_MEM_STAT("Total allocated memory", std::to_string(getMemoryUsageInMB()) + "MB");
-			SET_MEM_STAT("Heap", std::to_string(getHeapUsageBytes() / (1024 * 1024)) + "MB");
-			SET_MEM_STAT("Stack", std::to_string(getStackUsageBytes()) + " Bytes");
+			// Process memory queries are syscalls (or file reads on Linux), once a second is enough
+			if (std::chrono::steady_clock::now() >= nextMemorySample) {
+				SET_MEM_STAT("Total allocated memory", getMemoryUsageInMB(), Megabytes);
+				SET_MEM_STAT("Heap", getHeapUsageBytes(), Bytes);
+				SET_MEM_STAT("Stack", getStackUsageBytes(), Bytes);
+				nextMemorySample += std::chrono::seconds(1);
+			}
 
-			SET_GEN_STAT("FPS", std::to_string(1.f / Time::unscaledDeltaTime()));
-			SET_GEN_STAT("Possible FPS", std::to_string(1.f / Time::getMaxPossibleFPS()));
-			SET_CPU_STAT("Main thread", std::to_string(Time::deltaTime()) + " ms");
-			SET_GEN_STAT("Elapsed time", std::to_string(Time::elapsedTime()));
+			SET_GEN_STAT("FPS", 1.f / Time::unscaledDeltaTime(), None);
+			SET_GEN_STAT("Possible FPS", 1.f / Time::getMaxPossibleFPS(), None);
+			SET_CPU_STAT("Main thread", Time::deltaTime() * 1000.f, Milliseconds);
+			SET_GEN_STAT("Elapsed time", Time::elapsedTime(), Seconds);
 
 			auto frameStart = std::chrono::steady_clock::now();
 			float deltaSeconds = std::chrono::duration<float>(frameStart - lastFrameTime).count();
 			lastFrameTime = frameStart;
+			InputRecorder::beginFrame(deltaSeconds);
 			engine::Time::update(deltaSeconds);
 
 			if (m_window.isWindowResized()) {
@@ -193,6 +208,8 @@ namespace engine {
 			}
 
 
+			SaveSystem::poll();
+
 			Profiler::Get().EndFrame();
 			m_window.swapBuffers();
 			glfwPollEvents();
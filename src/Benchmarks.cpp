@@ -0,0 +1,202 @@
+#include "Benchmarks.h"
+#include "Core/Scene.h"
+#include "Components/Transform.h"
+#include "Components/Spriterenderer.h"
+#include "CpuFeatures.h"
+#include "TransformBatch.h"
+#include "PerlinNoise.h"
+#include "Inactive.h"
+#include "SpatialHash.h"
+#include "Utils/AABB.h"
+#include "Utils/randomr.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace engine {
+	namespace {
+		// Best of ten runs in ms, pass returns a value that is kept alive so nothing is optimized out
+		template<typename Pass>
+		double bestOf(Pass&& pass) {
+			double best = 1e9;
+			float sum = 0.f;
+			for (int run = 0; run < 10; ++run) {
+				const auto start = std::chrono::steady_clock::now();
+				sum += pass();
+				best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+			volatile float sink = sum;
+			(void)sink;
+			return best;
+		}
+
+		// view<Transform2D, SpriteRenderer> against the scene's render group
+		void iteration(int amount) {
+			entt::registry registry;
+			auto group = Scene::renderGroup(registry);
+
+			// Every third entity without a sprite (cameras, triggers ...), sprites in another order than the transforms
+			std::vector<entt::entity> entities(amount);
+			registry.create(entities.begin(), entities.end());
+			for (int i = 0; i < amount; ++i)
+				registry.emplace<Transform2D>(entities[i], Transform2D::FromPosition({ float(i), 0.f }));
+			rnd::Xoshiro256 rng{ 42 };
+			std::shuffle(entities.begin(), entities.end(), rng);
+			for (int i = 0; i < amount; ++i) {
+				if (i % 3 != 0) registry.emplace<graphics::SpriteRenderer>(entities[i]);
+			}
+
+			const double viewMs = bestOf([&] {
+				float sum = 0.f;
+				for (auto [ent, tr, sprite] : registry.view<Transform2D, graphics::SpriteRenderer>(entt::exclude<Inactive>).each())
+					sum += tr.position().x * sprite.color.w;
+				return sum;
+			});
+			const double groupMs = bestOf([&] {
+				float sum = 0.f;
+				for (auto [ent, sprite, tr] : group.each())
+					sum += tr.position().x * sprite.color.w;
+				return sum;
+			});
+
+			std::cout << "[INFO] " << group.size() << " von " << amount << " Entities: View " << viewMs << " ms, Gruppe " << groupMs
+				<< " ms (x" << viewMs / std::max(groupMs, 1e-6) << ")\n";
+		}
+
+		// TransformBatch on every SIMD level the CPU has, against the per transform cache rebuild
+		void transforms(int amount) {
+			rnd::Xoshiro256 rng{ 42 };
+			std::uniform_real_distribution<float> position(-1000.f, 1000.f), scale(0.5f, 4.f), angle(-10.f, 10.f);
+			std::vector<Transform2D> source(amount);
+			TransformBatch batch;
+			batch.reserve(amount);
+			for (Transform2D& transform : source) {
+				transform.set({ position(rng), position(rng) }, { scale(rng), scale(rng) }, angle(rng));
+				batch.push(transform);
+			}
+
+			// std::sin/cos in set(), the matrix and bounds in mat3(), what a transform costs without the batch
+			const double scalarMs = bestOf([&] {
+				float sum = 0.f;
+				for (Transform2D& transform : source) {
+					transform.setRotationRadians(transform.rotation());
+					sum += transform.mat3()[0][0];
+				}
+				return sum;
+			});
+			std::cout << "[INFO] " << amount << " Transforms: einzeln (std::sin/cos) " << scalarMs << " ms";
+
+			const CpuFeatures::Simd detected = CpuFeatures::detected();
+			for (CpuFeatures::Simd level : { CpuFeatures::Simd::Avx2, CpuFeatures::Simd::Sse2, CpuFeatures::Simd::Scalar }) {
+				if (level > detected) continue;
+				CpuFeatures::limit(level);
+				const double batchMs = bestOf([&] {
+					batch.compute();
+					return batch.models().back()[0][0];
+				});
+				std::cout << ", Batch " << CpuFeatures::name(level) << " " << batchMs << " ms";
+			}
+			CpuFeatures::limit(CpuFeatures::Simd::Avx2);
+			std::cout << "\n";
+		}
+
+		// Perlin2DBatch on every SIMD level the CPU has, against Perlin2D per sample
+		void noise(int amount) {
+			const PerlinNoise perlin{ 42 };
+			rnd::Xoshiro256 rng{ 42 };
+			std::uniform_real_distribution<float> coordinate(-500.f, 500.f);
+			std::vector<float> xs(amount), ys(amount), out(amount);
+			for (int i = 0; i < amount; ++i) {
+				xs[i] = coordinate(rng);
+				ys[i] = coordinate(rng);
+			}
+
+			const double singleMs = bestOf([&] {
+				float sum = 0.f;
+				for (int i = 0; i < amount; ++i)
+					sum += perlin.Perlin2D(xs[i], ys[i]);
+				return sum;
+			});
+			std::cout << "[INFO] " << amount << " Perlin-Samples: einzeln " << singleMs << " ms";
+
+			const CpuFeatures::Simd detected = CpuFeatures::detected();
+			for (CpuFeatures::Simd level : { CpuFeatures::Simd::Avx2, CpuFeatures::Simd::Sse2 }) {
+				if (level > detected) continue;
+				CpuFeatures::limit(level);
+				const double batchMs = bestOf([&] {
+					perlin.Perlin2DBatch(xs.data(), ys.data(), out.data(), out.size());
+					return out.back();
+				});
+				std::cout << ", Batch " << CpuFeatures::name(level) << " " << batchMs << " ms";
+			}
+			CpuFeatures::limit(CpuFeatures::Simd::Avx2);
+			std::cout << "\n";
+		}
+
+		// The two ways RenderSystem::render collects visible sprites, walking the render group
+		// against querying the spatial index, for views covering more and more of the world
+		void collect(int amount) {
+			entt::registry registry;
+			auto group = Scene::renderGroup(registry);
+			SpatialHash index;
+
+			// Like iteration: every third entity without a sprite, sprites in another order than the transforms
+			rnd::Xoshiro256 rng{ 42 };
+			std::uniform_real_distribution<float> position(-500.f, 500.f);
+			std::vector<entt::entity> entities(amount);
+			registry.create(entities.begin(), entities.end());
+			for (entt::entity entity : entities) {
+				const Transform2D& transform = registry.emplace<Transform2D>(entity, Transform2D::FromPosition({ position(rng), position(rng) }));
+				index.update(entity, graphics::AABB::create(transform));
+			}
+			std::shuffle(entities.begin(), entities.end(), rng);
+			for (int i = 0; i < amount; ++i) {
+				if (i % 3 != 0) registry.emplace<graphics::SpriteRenderer>(entities[i]);
+			}
+
+			std::vector<glm::mat3> instances;
+			instances.reserve(group.size());
+			for (float share : { 0.02f, 0.1f, 0.25f, 0.4f, 0.6f, 1.f }) {
+				const float half = 500.f * std::sqrt(share);
+				const graphics::AABB view{ { -half, -half }, { half, half } };
+
+				const double groupMs = bestOf([&] {
+					instances.clear();
+					for (auto [ent, sprite, tr] : group.each()) {
+						if (sprite.color.w <= 0.0f || !graphics::AABB::intersects(graphics::AABB::create(tr), view)) continue;
+						instances.push_back(tr.mat3());
+					}
+					return static_cast<float>(instances.size());
+				});
+				const double indexMs = bestOf([&] {
+					instances.clear();
+					index.queryRect(view, [&](entt::entity ent, const graphics::AABB&) {
+						const graphics::SpriteRenderer* sprite = registry.try_get<graphics::SpriteRenderer>(ent);
+						if (sprite == nullptr || sprite->color.w <= 0.0f) return;
+						instances.push_back(registry.get<Transform2D>(ent).mat3());
+					});
+					return static_cast<float>(instances.size());
+				});
+
+				std::cout << "[INFO] " << share * 100.f << "% der Welt sichtbar (" << instances.size() << " von " << group.size()
+					<< " Sprites): Gruppe " << groupMs << " ms, Index " << indexMs << " ms\n";
+			}
+		}
+	}
+
+	namespace Benchmarks {
+		bool run(const std::string& name, int count) {
+			if (name == "iteration") iteration(count);
+			else if (name == "transforms") transforms(count);
+			else if (name == "noise") noise(count);
+			else if (name == "collect") collect(count);
+			else return false;
+			return true;
+		}
+
+		const char* names() { return "iteration|transforms|noise|collect"; }
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+
+namespace engine {
+	// Micro benchmarks behind the "bench <name> [count]" console command. Each one builds its own
+	// data, the network thread that runs them never touches the live scenes. Results go to stdout.
+	namespace Benchmarks {
+		// False for an unknown name
+		bool run(const std::string& name, int count);
+		// Names for the usage message, separated by '|'
+		const char* names();
+	}
+}
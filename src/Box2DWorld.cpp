@@ -19,7 +19,7 @@ namespace engine {
 	b2BodyId Box2DWorld::createBody(entt::entity handle, Scene& scene, BodyType bodyType) {
 		Transform2D& tr = scene.getComponent<Transform2D>(handle);
 
-		b2Vec2 box2dPos(tr.position.x, tr.position.y);
+		b2Vec2 box2dPos(tr.position().x, tr.position().y);
 
 
 		b2BodyDef bodyDef = b2DefaultBodyDef();
@@ -46,18 +46,18 @@ namespace engine {
 
 		if (shapeType == ShapeType::Box) {
 
-			b2Polygon b2Polygon = b2MakeBox(0.5f * transform.scale.x, 0.5f * transform.scale.y);
+			b2Polygon b2Polygon = b2MakeBox(0.5f * transform.scale().x, 0.5f * transform.scale().y);
 			shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &b2Polygon);
 		}
 		else if (shapeType == ShapeType::Circle)
 		{
-			float r = 0.25f * (transform.scale.x + transform.scale.y);
+			float r = 0.25f * (transform.scale().x + transform.scale().y);
 			b2Circle circle = { b2Vec2{0,0}, r };
 			shapeId = b2CreateCircleShape(bodyId, &shapeDef, &circle);
 		}
 
 
-		b2Body_SetTransform(bodyId, b2Vec2(transform.position.x, transform.position.y), transform.b2Rotation());
+		b2Body_SetTransform(bodyId, b2Vec2(transform.position().x, transform.position().y), transform.b2Rotation());
 		return shapeId;
 	}
 
@@ -16,7 +16,7 @@ namespace engine {
 		void scale(glm::vec2 scale, Scene& scene) {
 			glm::vec2 center = this->center();
 			Transform2D tr = scene.getComponent<Transform2D>(handle);
-			b2Polygon polygon = b2MakeOffsetBox(tr.scale.x * scale.x * 0.5f, tr.scale.y * scale.y * 0.5f, b2Vec2(center.x, center.y), tr.b2Rotation());
+			b2Polygon polygon = b2MakeOffsetBox(tr.scale().x * scale.x * 0.5f, tr.scale().y * scale.y * 0.5f, b2Vec2(center.x, center.y), tr.b2Rotation());
 			b2Shape_SetPolygon(shapeId, &polygon);
 		}
 
@@ -57,7 +57,7 @@ namespace engine {
 						polygon.vertices[2].y - polygon.vertices[0].y
 					);
 					size += glm::vec2{ 1.f };
-					return size - tr.scale;
+					return size - tr.scale();
 				}
 				else {
 					throw std::runtime_error("This boxshape polygon count equals " + std::to_string(polygon.count) + " instead of 4");
@@ -75,13 +75,13 @@ namespace engine {
 			glm::vec2 center = this->center();
 			Transform2D tr = scene.getComponent<Transform2D>(handle);
 
-			b2Polygon polygon = b2MakeOffsetBox(tr.scale.x * 0.5f, tr.scale.y * 0.5f, b2Vec2(center.x, center.y), tr.b2Rotation());
+			b2Polygon polygon = b2MakeOffsetBox(tr.scale().x * 0.5f, tr.scale().y * 0.5f, b2Vec2(center.x, center.y), tr.b2Rotation());
 			b2Shape_SetPolygon(shapeId, &polygon);
 		}
 
 		void center(glm::vec2 center, Scene& scene) {
 			Transform2D tr = scene.getComponent<Transform2D>(handle);
-			b2Polygon polygon = b2MakeOffsetBox(tr.scale.x * 0.5f, tr.scale.y * 0.5f, b2Vec2(center.x, center.y), b2Rot_identity);
+			b2Polygon polygon = b2MakeOffsetBox(tr.scale().x * 0.5f, tr.scale().y * 0.5f, b2Vec2(center.x, center.y), b2Rot_identity);
 			b2Shape_SetPolygon(shapeId, &polygon);
 		}
 		glm::vec2 center() {
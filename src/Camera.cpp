@@ -28,7 +28,7 @@ namespace graphics {
     }
 
     void Camera::updateViewYXZ() {
-        float theta = transform->rotation;
+        float theta = transform->rotation();
         // Fr den View-Matrix sollte man um -theta rotieren:
         float c = glm::cos(-theta);
         float s = glm::sin(-theta);
@@ -39,7 +39,7 @@ namespace graphics {
         rotation[1][0] = s;
         rotation[1][1] = c;
 
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(-transform->position, 0.0f));
+        glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(-transform->position(), 0.0f));
 
         m_viewMatrix = rotation * translation;
     }
@@ -51,14 +51,14 @@ namespace graphics {
 			glm::vec2 worldViewport = worldViewPort();
 
 			glm::vec2 worldPos;
-			worldPos.x = ndcX * (worldViewport.x / 2.0f) + transform->position.x;
-			worldPos.y = ndcY * (worldViewport.y / 2.0f) + transform->position.y;
+			worldPos.x = ndcX * (worldViewport.x / 2.0f) + transform->position().x;
+			worldPos.y = ndcY * (worldViewport.y / 2.0f) + transform->position().y;
 
 			return worldPos;
 		}
 		AABB viewportAABB() {
 			glm::vec2 viewPort = worldViewPort();
-			return AABB::create(transform->position, viewPort / 2.f);
+			return AABB::create(transform->position(), viewPort / 2.f);
 		}
 
 		static Camera* main() {
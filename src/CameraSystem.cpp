@@ -7,7 +7,7 @@ namespace engine {
 
 	void CameraSystem::update(Scene& scene) {
 		if (Input::getMouseButton(1))
-			m_camera->transform->position += Input::mouseAxis() * m_camera->orthographicSize() / 250.f;
+			m_camera->transform->translate(Input::mouseAxis() * m_camera->orthographicSize() / 250.f);
 
 		float speed = 2.25f * engine::Time::deltaTime() * m_camera->orthographicSize();
 		size += -Input::scrollValue() * m_camera->orthographicSize() / 3.f;
@@ -30,7 +30,7 @@ namespace LLB {
 		cpBody* body = nullptr;
 
 		if (bodyType == BodyType::Dynamic) {
-			float moment = cpMomentForBox(1.f, tr.scale.x, tr.scale.y);
+			float moment = cpMomentForBox(1.f, tr.scale().x, tr.scale().y);
 			body = cpBodyNew(1.0f, moment); // Mass = 1.0f, Moment = unendlich (kein Drehen)
 		}
 		else if (bodyType == BodyType::Static) {
@@ -40,8 +40,8 @@ namespace LLB {
 			body = cpBodyNewKinematic();
 		}
 
-		cpBodySetPosition(body, cpv(tr.position.x, tr.position.y));
-		cpBodySetAngle(body, tr.rotation);
+		cpBodySetPosition(body, cpv(tr.position().x, tr.position().y));
+		cpBodySetAngle(body, tr.rotation());
 
 		// Entity als UserData speichern (wichtig fr sptere Collision-Callbacks)
 		cpBodySetUserData(body, reinterpret_cast<cpDataPointer>(static_cast<uintptr_t>(handle)));
@@ -66,12 +66,12 @@ namespace LLB {
 	ShapeHandle ChipmunkWorld::CreateShape(entt::entity handle, Scene& scene, BodyHandle bodyHandle, ShapeType shapeType) {
 		if (shapeType == ShapeType::Box) {
 			Transform2D transform = scene.GetComponent<Transform2D>(handle);
-			cpShape* shape = cpBoxShapeNew(bodyHandle.ptr, transform.scale.x, transform.scale.y, 0.f);
+			cpShape* shape = cpBoxShapeNew(bodyHandle.ptr, transform.scale().x, transform.scale().y, 0.f);
 			ShapeHandle shapeHandle;
 			shapeHandle.ptr = shape;
 
-			cpBodySetPosition(bodyHandle.ptr, cpv(transform.position.x, transform.position.y));
-			cpBodySetAngle(bodyHandle.ptr, transform.rotation);
+			cpBodySetPosition(bodyHandle.ptr, cpv(transform.position().x, transform.position().y));
+			cpBodySetAngle(bodyHandle.ptr, transform.rotation());
 
 			// Shape in den Space einfgen
 			cpShapeSetFriction(shape, 0.7f);    // normale Reibung
@@ -0,0 +1,278 @@
+#include "ChunkGenerator.h"
+#include "JobSystem.h"
+#include "Core/Profiler.h"
+#include "Utils/Debug.h"
+#include <lz4.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace engine {
+	struct ChunkGenerator::State {
+		State(uint32_t seed, std::filesystem::path directory)
+			: elevation(seed), moisture(seed ^ 0x9E3779B9u), ore(seed ^ 0x85EBCA6Bu), seed(seed), cacheDirectory(std::move(directory)) {}
+
+		PerlinNoise elevation;
+		PerlinNoise moisture;
+		PerlinNoise ore;
+		uint32_t seed;
+		std::filesystem::path cacheDirectory;
+
+		mutable std::mutex mutex;
+		std::vector<ChunkCoord> pending;
+		std::unordered_set<ChunkCoord, ChunkCoordHash> queued;   // pending, in flight and finished but not taken
+		std::vector<std::unique_ptr<Chunk>> finished;
+		glm::vec2 focus{ 0.f };
+		size_t inFlight = 0;
+		std::atomic<bool> stopped{ false };
+	};
+
+	namespace {
+		struct CacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t seed;
+			uint32_t chunkSize;
+			uint32_t rawSize;
+			uint32_t storedSize;
+		};
+
+		constexpr uint32_t k_cacheMagic = 0x4B484345; // "ECHK"
+		constexpr size_t k_layerSize = Chunk::k_size * Chunk::k_size;
+
+		float distanceSquared(ChunkCoord coord, glm::vec2 focus) {
+			const float dx = (static_cast<float>(coord.x) + 0.5f) * Chunk::k_size - focus.x;
+			const float dy = (static_cast<float>(coord.y) + 0.5f) * Chunk::k_size - focus.y;
+			return dx * dx + dy * dy;
+		}
+
+		std::filesystem::path cachePath(const std::filesystem::path& directory, ChunkCoord coord) {
+			return directory / ("chunk_" + std::to_string(coord.x) + "_" + std::to_string(coord.y) + ".bin");
+		}
+	}
+
+	ChunkGenerator::ChunkGenerator(uint32_t seed, std::filesystem::path cacheDirectory, size_t maxInFlight)
+		: m_seed{ seed },
+		m_maxInFlight{ maxInFlight > 0 ? maxInFlight : std::max<size_t>(1, ThreadPool::global().threadCount()) },
+		m_state{ std::make_shared<State>(seed, std::move(cacheDirectory)) }
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_state->cacheDirectory, error);
+		if (error)
+			Debug::logWarning("Chunk cache directory unavailable, chunks will not be cached: " + error.message());
+	}
+
+	ChunkGenerator::~ChunkGenerator() {
+		m_state->stopped.store(true, std::memory_order_relaxed);
+	}
+
+	void ChunkGenerator::request(ChunkCoord coord) {
+		std::lock_guard lock(m_state->mutex);
+		if (m_state->queued.insert(coord).second)
+			m_state->pending.push_back(coord);
+	}
+
+	void ChunkGenerator::setFocus(glm::vec2 worldPosition, float maxDistance) {
+		std::lock_guard lock(m_state->mutex);
+		m_state->focus = worldPosition;
+
+		// Per axis, the streamed area is a square around the focus
+		const float limit = maxDistance * Chunk::k_size;
+		auto& pending = m_state->pending;
+		auto far = std::remove_if(pending.begin(), pending.end(), [&](ChunkCoord coord) {
+			const float dx = std::abs((static_cast<float>(coord.x) + 0.5f) * Chunk::k_size - worldPosition.x);
+			const float dy = std::abs((static_cast<float>(coord.y) + 0.5f) * Chunk::k_size - worldPosition.y);
+			if (dx <= limit && dy <= limit) return false;
+			m_state->queued.erase(coord);
+			return true;
+		});
+		pending.erase(far, pending.end());
+	}
+
+	void ChunkGenerator::pump() {
+		std::shared_ptr<State> state = m_state;
+		size_t toStart = 0;
+		{
+			std::lock_guard lock(state->mutex);
+			while (state->inFlight + toStart < m_maxInFlight && toStart < state->pending.size())
+				++toStart;
+			state->inFlight += toStart;
+		}
+		// Each task takes whatever is nearest when it starts, not when it was scheduled
+		for (size_t i = 0; i < toStart; ++i)
+			ThreadPool::global().schedule([state] { work(state); });
+	}
+
+	std::vector<std::unique_ptr<Chunk>> ChunkGenerator::takeFinished() {
+		std::lock_guard lock(m_state->mutex);
+		// Requests for these are ignored until here, the caller only learns about them now
+		for (const auto& chunk : m_state->finished)
+			m_state->queued.erase(chunk->coord);
+		return std::exchange(m_state->finished, {});
+	}
+
+	size_t ChunkGenerator::pendingCount() const {
+		std::lock_guard lock(m_state->mutex);
+		return m_state->pending.size();
+	}
+
+	size_t ChunkGenerator::inFlightCount() const {
+		std::lock_guard lock(m_state->mutex);
+		return m_state->inFlight;
+	}
+
+	void ChunkGenerator::work(const std::shared_ptr<State>& state) {
+		ChunkCoord coord;
+		{
+			std::lock_guard lock(state->mutex);
+			if (state->pending.empty() || state->stopped.load(std::memory_order_relaxed)) {
+				--state->inFlight;
+				return;
+			}
+			auto nearest = std::min_element(state->pending.begin(), state->pending.end(), [&](ChunkCoord a, ChunkCoord b) {
+				return distanceSquared(a, state->focus) < distanceSquared(b, state->focus);
+			});
+			coord = *nearest;
+			*nearest = state->pending.back();
+			state->pending.pop_back();
+		}
+
+		std::unique_ptr<Chunk> chunk;
+		try {
+			chunk = loadCached(*state, coord);
+			if (!chunk) {
+				chunk = generate(*state, coord);
+				storeCached(*state, *chunk);
+			}
+		}
+		catch (const std::exception& e) {
+			Debug::logError("Chunk " + std::to_string(coord.x) + ", " + std::to_string(coord.y) + " failed: " + e.what());
+		}
+
+		std::lock_guard lock(state->mutex);
+		--state->inFlight;
+		// A finished chunk stays queued until takeFinished() hands it out
+		if (chunk && !state->stopped.load(std::memory_order_relaxed))
+			state->finished.push_back(std::move(chunk));
+		else
+			state->queued.erase(coord);
+	}
+
+	std::unique_ptr<Chunk> ChunkGenerator::generate(const State& state, ChunkCoord coord) {
+		PROFILE_ZONE("World::GenerateChunk");
+		constexpr int size = Chunk::k_size;
+		const float x0 = static_cast<float>(coord.x) * size;
+		const float y0 = static_cast<float>(coord.y) * size;
+
+		thread_local std::vector<float> elevation, moisture, ore;
+		elevation.resize(k_layerSize);
+		moisture.resize(k_layerSize);
+		ore.resize(k_layerSize);
+
+		state.elevation.FillWarped(elevation.data(), size, size, x0, y0, 1.f,
+			FractalSettings{ 6, 1.f / 256.f, 2.f, 0.5f }, WarpSettings{ 24.f, FractalSettings{ 3, 1.f / 512.f, 2.f, 0.5f } });
+		state.moisture.FillFbm(moisture.data(), size, size, x0, y0, 1.f, FractalSettings{ 4, 1.f / 384.f, 2.f, 0.5f });
+		state.ore.FillRidged(ore.data(), size, size, x0, y0, 1.f, FractalSettings{ 3, 1.f / 48.f, 2.f, 0.5f });
+
+		auto chunk = std::make_unique<Chunk>();
+		chunk->coord = coord;
+		for (size_t i = 0; i < k_layerSize; ++i) {
+			const float e = elevation[i];
+			const float m = moisture[i];
+
+			TileType tile;
+			// fBm clusters around 0.5, the bands are narrow on purpose
+			if (e < 0.45f) tile = TileType::Water;
+			else if (e < 0.47f) tile = TileType::Sand;
+			else if (e < 0.56f) tile = m > 0.52f ? TileType::Forest : TileType::Grass;
+			else if (e < 0.61f) tile = TileType::Stone;
+			else tile = TileType::Snow;
+			chunk->tiles[i] = tile;
+
+			// Ore veins along the ridges, the kind depends on the terrain they cross
+			ResourceType resource = ResourceType::None;
+			if (tile != TileType::Water && tile != TileType::Sand && ore[i] > 0.9f) {
+				if (tile == TileType::Stone || tile == TileType::Snow) resource = m > 0.5f ? ResourceType::Iron : ResourceType::Stone;
+				else resource = m > 0.5f ? ResourceType::Copper : ResourceType::Coal;
+			}
+			chunk->resources[i] = resource;
+		}
+		PROFILE_ZONE_ITEMS(static_cast<uint32_t>(k_layerSize));
+		return chunk;
+	}
+
+	std::unique_ptr<Chunk> ChunkGenerator::loadCached(const State& state, ChunkCoord coord) {
+		const std::filesystem::path path = cachePath(state.cacheDirectory, coord);
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+		file = std::fopen(path.c_str(), "rb");
+#endif
+		if (!file) return nullptr;
+		PROFILE_ZONE("World::LoadChunk");
+
+		CacheHeader header{};
+		std::vector<char> stored;
+		bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+			&& header.magic == k_cacheMagic && header.version == k_generatorVersion && header.seed == state.seed
+			&& header.chunkSize == Chunk::k_size && header.rawSize == 2 * k_layerSize
+			&& header.storedSize <= static_cast<uint32_t>(LZ4_compressBound(static_cast<int>(header.rawSize)));
+		if (ok) {
+			stored.resize(header.storedSize);
+			ok = std::fread(stored.data(), 1, stored.size(), file) == stored.size();
+		}
+		std::fclose(file);
+		// Stale or damaged entries are simply regenerated and overwritten
+		if (!ok) return nullptr;
+
+		char raw[2 * k_layerSize];
+		if (LZ4_decompress_safe(stored.data(), raw, static_cast<int>(header.storedSize), static_cast<int>(header.rawSize)) != static_cast<int>(header.rawSize))
+			return nullptr;
+
+		auto chunk = std::make_unique<Chunk>();
+		chunk->coord = coord;
+		chunk->fromCache = true;
+		std::memcpy(chunk->tiles.data(), raw, k_layerSize);
+		std::memcpy(chunk->resources.data(), raw + k_layerSize, k_layerSize);
+		return chunk;
+	}
+
+	void ChunkGenerator::storeCached(const State& state, const Chunk& chunk) {
+		PROFILE_ZONE("World::StoreChunk");
+		char raw[2 * k_layerSize];
+		std::memcpy(raw, chunk.tiles.data(), k_layerSize);
+		std::memcpy(raw + k_layerSize, chunk.resources.data(), k_layerSize);
+
+		std::vector<char> stored(LZ4_compressBound(static_cast<int>(sizeof(raw))));
+		const int storedSize = LZ4_compress_default(raw, stored.data(), static_cast<int>(sizeof(raw)), static_cast<int>(stored.size()));
+		if (storedSize <= 0) return;
+
+		const CacheHeader header{ k_cacheMagic, k_generatorVersion, state.seed, Chunk::k_size, static_cast<uint32_t>(sizeof(raw)), static_cast<uint32_t>(storedSize) };
+
+		// Written under a temporary name so a reader never sees a half written chunk
+		const std::filesystem::path path = cachePath(state.cacheDirectory, chunk.coord);
+		std::filesystem::path temporary = path;
+		temporary += ".tmp";
+
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0) file = nullptr;
+#else
+		file = std::fopen(temporary.c_str(), "wb");
+#endif
+		if (!file) return;
+		bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+			&& std::fwrite(stored.data(), 1, storedSize, file) == static_cast<size_t>(storedSize);
+		ok = std::fclose(file) == 0 && ok;
+
+		std::error_code error;
+		if (ok)
+			std::filesystem::rename(temporary, path, error);
+		if (!ok || error)
+			std::filesystem::remove(temporary, error);
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "PerlinNoise.h"
+#include <glm/glm.hpp>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace engine {
+	enum class TileType : uint8_t { Water, Sand, Grass, Forest, Stone, Snow };
+	enum class ResourceType : uint8_t { None, Coal, Iron, Copper, Stone };
+
+	struct ChunkCoord {
+		int32_t x = 0;
+		int32_t y = 0;
+
+		bool operator==(const ChunkCoord& other) const { return x == other.x && y == other.y; }
+	};
+
+	struct ChunkCoordHash {
+		size_t operator()(const ChunkCoord& c) const {
+			return std::hash<uint64_t>{}((static_cast<uint64_t>(static_cast<uint32_t>(c.x)) << 32) | static_cast<uint32_t>(c.y));
+		}
+	};
+
+	struct Chunk {
+		static constexpr int k_size = 64;   // Tiles per side, one tile is one world unit
+
+		ChunkCoord coord;
+		std::array<TileType, k_size * k_size> tiles;
+		std::array<ResourceType, k_size * k_size> resources;
+		bool fromCache = false;
+
+		TileType tile(int x, int y) const { return tiles[y * k_size + x]; }
+		ResourceType resource(int x, int y) const { return resources[y * k_size + x]; }
+
+		static ChunkCoord coordOf(glm::vec2 worldPosition) {
+			return { static_cast<int32_t>(std::floor(worldPosition.x / k_size)), static_cast<int32_t>(std::floor(worldPosition.y / k_size)) };
+		}
+	};
+
+	// Generates chunks on ThreadPool::global(). Requests are picked nearest to the focus first
+	// when a worker becomes free, finished chunks are written to the cache directory and
+	// read back from there on later visits. Nothing here blocks the calling thread.
+	class ChunkGenerator {
+	public:
+		ChunkGenerator(uint32_t seed, std::filesystem::path cacheDirectory, size_t maxInFlight = 0);
+		~ChunkGenerator();
+
+		ChunkGenerator(const ChunkGenerator&) = delete;
+		ChunkGenerator& operator=(const ChunkGenerator&) = delete;
+
+		// Ignored if the chunk is already queued, being generated or finished but not taken yet
+		void request(ChunkCoord coord);
+		// Drops queued requests more than maxDistance chunks from the focus along x or y
+		void setFocus(glm::vec2 worldPosition, float maxDistance);
+		// Starts queued work up to the in-flight limit, called once per frame
+		void pump();
+		// Chunks finished since the last call
+		std::vector<std::unique_ptr<Chunk>> takeFinished();
+
+		size_t pendingCount() const;
+		size_t inFlightCount() const;
+
+		uint32_t seed() const { return m_seed; }
+
+		// Bump when the generation changes, cached chunks of another version are regenerated
+		static constexpr uint32_t k_generatorVersion = 1;
+
+	private:
+		struct State;
+
+		static void work(const std::shared_ptr<State>& state);
+		static std::unique_ptr<Chunk> generate(const State& state, ChunkCoord coord);
+		static std::unique_ptr<Chunk> loadCached(const State& state, ChunkCoord coord);
+		static void storeCached(const State& state, const Chunk& chunk);
+
+		uint32_t m_seed;
+		size_t m_maxInFlight;
+		// Shared with the worker tasks so they can finish safely after the generator is gone
+		std::shared_ptr<State> m_state;
+	};
+}
@@ -88,6 +88,18 @@ namespace engine {
 			return  b2Rot_GetAngle(rotation);
 		}
 
+		void enable(bool enabled) {
+			if (enabled)
+				b2Body_Enable(m_bodyId);
+			else
+				b2Body_Disable(m_bodyId);
+		}
+
+		// The physics pass only moves bodies of rigidbodies, static ones are placed here
+		void setBodyTransform(const Transform2D& transform) {
+			b2Body_SetTransform(m_bodyId, b2Vec2(transform.position().x, transform.position().y), transform.b2Rotation());
+		}
+
 	private:
 		void SetRotation(float radiant) {
 			b2Body_SetTransform(m_bodyId, b2Body_GetPosition(m_bodyId), b2Rot(std::cos(radiant), std::sin(radiant)));
@@ -0,0 +1,66 @@
+#include "CommandBuffer.h"
+#include "Core/Scene.h"
+#include "Core/Profiler.h"
+
+namespace engine {
+	bool CommandBuffer::empty() const {
+		if (m_spawnCount > 0 || !m_destroyed.empty() || !m_deferred.empty()) return false;
+		for (const auto& [id, commands] : m_types) {
+			if (!commands->empty()) return false;
+		}
+		return true;
+	}
+
+	void CommandBuffer::clear() {
+		m_spawnCount = 0;
+		m_spawned.clear();
+		m_destroyed.clear();
+		m_deferred.clear();
+		for (auto& [id, commands] : m_types)
+			commands->clear();
+	}
+
+	void CommandBuffer::swap(CommandBuffer& other) {
+		std::swap(m_spawnCount, other.m_spawnCount);
+		m_spawned.swap(other.m_spawned);
+		m_destroyed.swap(other.m_destroyed);
+		m_deferred.swap(other.m_deferred);
+		m_types.swap(other.m_types);
+	}
+
+	void CommandBuffer::flush(Scene& scene) {
+		if (empty()) return;
+		PROFILE_ZONE("Scene::FlushCommands");
+
+		// Applied from a separate buffer so deferred calls can keep recording into this one
+		CommandBuffer batch;
+		swap(batch);
+		entt::registry& registry = scene.registry();
+
+		batch.m_spawned.resize(batch.m_spawnCount);
+		registry.create(batch.m_spawned.begin(), batch.m_spawned.end());
+		PROFILE_ZONE_ITEMS(batch.m_spawnCount);
+
+		for (auto& [id, commands] : batch.m_types)
+			commands->emplace(registry, batch.m_spawned);
+
+		for (auto& fn : batch.m_deferred)
+			fn(scene, batch.m_spawned);
+
+		for (auto& [id, commands] : batch.m_types)
+			commands->remove(registry);
+
+		auto& destroyed = batch.m_destroyed;
+		std::sort(destroyed.begin(), destroyed.end());
+		destroyed.erase(std::unique(destroyed.begin(), destroyed.end()), destroyed.end());
+		for (entt::entity entity : destroyed) {
+			// Checked one by one, destroying a parent already took its children along
+			if (registry.valid(entity))
+				scene.destroyEntity(entity);
+		}
+
+		// Keep the allocations when nothing new was recorded meanwhile
+		batch.clear();
+		if (empty()) swap(batch);
+	}
+}
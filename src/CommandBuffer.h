@@ -0,0 +1,156 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace engine {
+	class Scene;
+
+	// Structural changes recorded while iterating views or on worker threads and applied in
+	// bulk at a sync point (Scene::flushCommands()). A buffer is not thread-safe, every thread
+	// records into its own one, see Scene::commands().
+	// A flush creates all spawned entities in one go, then per component type emplaces the
+	// components (spawned entities with one insert, existing ones sorted by entity, the last
+	// emplace of an entity wins), runs the deferred calls, removes components and finally
+	// destroys entities. Commands on entities that are gone by then are dropped.
+	class CommandBuffer {
+	public:
+		// An entity that only exists after the flush
+		struct Spawn { uint32_t index; };
+
+		Spawn create() { return Spawn{ m_spawnCount++ }; }
+		void destroy(entt::entity entity) { m_destroyed.push_back(entity); }
+
+		template<typename T>
+		void emplace(entt::entity entity, T component = {}) {
+			auto& commands = typeCommands<T>();
+			commands.existing.push_back(entity);
+			commands.existingValues.push_back(std::move(component));
+		}
+		template<typename T>
+		void emplace(Spawn spawn, T component = {}) {
+			auto& commands = typeCommands<T>();
+			commands.spawns.push_back(spawn.index);
+			commands.spawnValues.push_back(std::move(component));
+		}
+		template<typename T>
+		void remove(entt::entity entity) { typeCommands<T>().removals.push_back(entity); }
+
+		// For work that needs the scene, e.g. components constructed with (entity, Scene&) like
+		// rigidbodies. Runs after all emplaces of the flush.
+		void defer(std::function<void(Scene&)> fn) {
+			m_deferred.push_back([fn = std::move(fn)](Scene& scene, const std::vector<entt::entity>&) { fn(scene); });
+		}
+		void defer(Spawn spawn, std::function<void(Scene&, entt::entity)> fn) {
+			m_deferred.push_back([spawn, fn = std::move(fn)](Scene& scene, const std::vector<entt::entity>& spawned) { fn(scene, spawned[spawn.index]); });
+		}
+
+		bool empty() const;
+		void clear();
+
+		// Applies everything recorded so far. Commands recorded during the flush, e.g. by deferred
+		// calls, stay in the buffer for the next one.
+		void flush(Scene& scene);
+
+	private:
+		struct TypeCommands {
+			virtual ~TypeCommands() = default;
+			virtual void emplace(entt::registry& registry, const std::vector<entt::entity>& spawned) = 0;
+			virtual void remove(entt::registry& registry) = 0;
+			virtual bool empty() const = 0;
+			virtual void clear() = 0;
+		};
+
+		template<typename T>
+		struct TypedCommands final : TypeCommands {
+			std::vector<entt::entity> existing;
+			std::vector<T> existingValues;
+			std::vector<uint32_t> spawns;
+			std::vector<T> spawnValues;
+			std::vector<entt::entity> removals;
+			std::vector<entt::entity> targets;
+			std::vector<uint32_t> order;
+
+			void emplace(entt::registry& registry, const std::vector<entt::entity>& spawned) override {
+				if (!spawns.empty()) {
+					targets.resize(spawns.size());
+					for (size_t i = 0; i < spawns.size(); ++i)
+						targets[i] = spawned[spawns[i]];
+
+					// Fresh entities, one insert unless the same spawn got this type twice
+					std::vector<uint32_t> sorted = spawns;
+					std::sort(sorted.begin(), sorted.end());
+					if (std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end()) {
+						if constexpr (std::is_empty_v<T>) registry.insert<T>(targets.begin(), targets.end());
+						else registry.insert<T>(targets.begin(), targets.end(), spawnValues.begin());
+					}
+					else {
+						for (size_t i = 0; i < targets.size(); ++i)
+							assign(registry, targets[i], std::move(spawnValues[i]));
+					}
+				}
+
+				if (!existing.empty()) {
+					// Entity order keeps the storage accesses local, stable so the last emplace wins
+					order.resize(existing.size());
+					std::iota(order.begin(), order.end(), 0u);
+					std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return existing[a] < existing[b]; });
+					for (size_t i = 0; i < order.size(); ++i) {
+						const entt::entity entity = existing[order[i]];
+						if (i + 1 < order.size() && existing[order[i + 1]] == entity) continue;
+						if (registry.valid(entity))
+							assign(registry, entity, std::move(existingValues[order[i]]));
+					}
+				}
+			}
+
+			void remove(entt::registry& registry) override {
+				if (removals.empty()) return;
+				std::sort(removals.begin(), removals.end());
+				removals.erase(std::unique(removals.begin(), removals.end()), removals.end());
+				removals.erase(std::remove_if(removals.begin(), removals.end(), [&](entt::entity entity) { return !registry.valid(entity); }), removals.end());
+				registry.remove<T>(removals.begin(), removals.end());
+			}
+
+			bool empty() const override { return existing.empty() && spawns.empty() && removals.empty(); }
+
+			void clear() override {
+				existing.clear();
+				existingValues.clear();
+				spawns.clear();
+				spawnValues.clear();
+				removals.clear();
+			}
+
+			static void assign(entt::registry& registry, entt::entity entity, T&& value) {
+				if constexpr (std::is_empty_v<T>) registry.emplace_or_replace<T>(entity);
+				else registry.emplace_or_replace<T>(entity, std::move(value));
+			}
+		};
+
+		template<typename T>
+		TypedCommands<T>& typeCommands() {
+			const entt::id_type id = entt::type_hash<T>::value();
+			for (auto& [typeId, commands] : m_types) {
+				if (typeId == id) return static_cast<TypedCommands<T>&>(*commands);
+			}
+			// Types in first-use order, which is also the order they are applied in
+			m_types.emplace_back(id, std::make_unique<TypedCommands<T>>());
+			return static_cast<TypedCommands<T>&>(*m_types.back().second);
+		}
+
+		void swap(CommandBuffer& other);
+
+		uint32_t m_spawnCount = 0;
+		std::vector<entt::entity> m_spawned;
+		std::vector<entt::entity> m_destroyed;
+		std::vector<std::function<void(Scene&, const std::vector<entt::entity>&)>> m_deferred;
+		std::vector<std::pair<entt::id_type, std::unique_ptr<TypeCommands>>> m_types;
+	};
+}
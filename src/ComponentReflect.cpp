@@ -0,0 +1,108 @@
+#include "ComponentReflect.h"
+#include "Components/Transform.h"
+#include "Components/Spriterenderer.h"
+#include "Hierarchy.h"
+#include <cstring>
+
+namespace engine {
+	namespace {
+		// Saved form of Transform2D, the original layout. The matrix, bounds, flags and the scene
+		// binding are runtime state, loading goes through the setters and rebuilds them.
+		struct StoredTransform2D {
+			glm::vec2 position;
+			glm::vec2 scale;
+			float rotation;
+			bool unused[2];
+		};
+
+		// Saved form of Hierarchy, the original layout. The parent version and dirty flag are
+		// not read back, loaded nodes start dirty and the scene binding is set when they are added.
+		struct StoredHierarchy {
+			entt::entity parent;
+			entt::entity firstChild;
+			entt::entity nextSibling;
+			entt::entity prevSibling;
+			uint32_t depth;
+			uint32_t childCount;
+			glm::vec2 localPosition;
+			glm::vec2 localScale;
+			float localRotation;
+			uint32_t unusedParentVersion;
+			bool unusedDirty;
+		};
+	}
+
+	std::vector<ComponentSchema>& ComponentReflect::storage() {
+		static std::vector<ComponentSchema> schemas;
+		static bool engineComponentsRegistered = false;
+
+		// Registration happens on the main thread, the flag is set first because add() lands here again
+		if (!engineComponentsRegistered) {
+			engineComponentsRegistered = true;
+			registerComponent<Transform2D, StoredTransform2D>("Transform2D", 1,
+				[](const Transform2D& transform, StoredTransform2D& out) {
+					out.position = transform.position();
+					out.scale = transform.scale();
+					out.rotation = transform.rotation();
+				},
+				[](const StoredTransform2D& stored) {
+					Transform2D transform = Transform2D::FromPositionScale(stored.position, stored.scale);
+					transform.setRotationRadians(stored.rotation);
+					return transform;
+				});
+			// TextureHandles are only meaningful if textures are loaded in the same order as when saving
+			registerComponent<graphics::SpriteRenderer>("SpriteRenderer", 1);
+			// Links are entity ids, valid because snapshots restore entities with their ids
+			registerComponent<Hierarchy, StoredHierarchy>("Hierarchy", 1,
+				[](const Hierarchy& node, StoredHierarchy& out) {
+					out.parent = node.parent;
+					out.firstChild = node.firstChild;
+					out.nextSibling = node.nextSibling;
+					out.prevSibling = node.prevSibling;
+					out.depth = node.depth;
+					out.childCount = node.childCount;
+					out.localPosition = node.localPosition();
+					out.localScale = node.localScale();
+					out.localRotation = node.localRotation();
+					out.unusedDirty = true;
+				},
+				[](const StoredHierarchy& stored) {
+					Hierarchy node;
+					node.parent = stored.parent;
+					node.firstChild = stored.firstChild;
+					node.nextSibling = stored.nextSibling;
+					node.prevSibling = stored.prevSibling;
+					node.depth = stored.depth;
+					node.childCount = stored.childCount;
+					node.setLocalPosition(stored.localPosition);
+					node.setLocalScale(stored.localScale);
+					node.setLocalRotationRadians(stored.localRotation);
+					return node;
+				});
+		}
+		return schemas;
+	}
+
+	void ComponentReflect::add(ComponentSchema schema) {
+		std::vector<ComponentSchema>& schemas = storage();
+		for (ComponentSchema& existing : schemas) {
+			if (existing.id == schema.id) {
+				existing = std::move(schema);
+				return;
+			}
+		}
+		schemas.push_back(std::move(schema));
+	}
+
+	const std::vector<ComponentSchema>& ComponentReflect::schemas() {
+		return storage();
+	}
+
+	const ComponentSchema* ComponentReflect::find(uint32_t id) {
+		for (const ComponentSchema& schema : storage()) {
+			if (schema.id == id)
+				return &schema;
+		}
+		return nullptr;
+	}
+}
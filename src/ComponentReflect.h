@@ -1 +1,166 @@
 #pragma once
+#include <entt/entt.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace engine {
+	// FNV-1a, stable across compilers and runs so ids can be written to save files
+	constexpr uint64_t fnv1a64(std::string_view text, uint64_t hash = 14695981039346656037ull) {
+		for (char c : text) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// How one component type is laid out in a scene snapshot. Components are stored as raw
+	// memory (or as the raw memory of their stored record), so the version has to be bumped
+	// whenever that layout changes.
+	struct ComponentSchema {
+		std::string name;
+		uint32_t id = 0;
+		uint32_t version = 1;
+		uint32_t size = 0;
+		uint64_t layoutHash = 0;
+
+		// Copies all entities owning the component followed by their component data into out
+		std::function<uint32_t(const entt::registry&, std::vector<char>& out)> save;
+		// Inserts count components, data has to be in the layout of the current version
+		std::function<void(entt::registry&, const entt::entity* entities, size_t count, const char* data)> load;
+		// Converts count components of an older version (elements of oldSize bytes) into the current layout
+		std::function<bool(const char* data, size_t count, uint32_t oldVersion, uint32_t oldSize, std::vector<char>& out)> migrate;
+
+		static uint64_t computeLayoutHash(std::string_view name, uint32_t size, uint32_t alignment, uint32_t version) {
+			uint64_t hash = fnv1a64(name);
+			const uint32_t layout[3] = { size, alignment, version };
+			return fnv1a64(std::string_view(reinterpret_cast<const char*>(layout), sizeof(layout)), hash);
+		}
+	};
+
+	class ComponentReflect {
+	public:
+		// Converts a single element stored by oldVersion into the current layout
+		template<typename T>
+		using Migration = std::function<bool(const char* oldData, uint32_t oldVersion, uint32_t oldSize, T& out)>;
+
+		template<typename T>
+		static void registerComponent(std::string_view name, uint32_t version = 1, Migration<T> migration = nullptr) {
+			static_assert(std::is_trivially_copyable_v<T>, "Snapshot components are stored as raw memory and must be trivially copyable");
+
+			ComponentSchema schema = makeSchema<T>(name, version, std::move(migration));
+
+			schema.save = [](const entt::registry& registry, std::vector<char>& out) -> uint32_t {
+				auto view = registry.view<T>();
+				const size_t count = view.size();
+				out.resize(count * (sizeof(entt::entity) + (std::is_empty_v<T> ? 0 : sizeof(T))));
+				entt::entity* entityOut = reinterpret_cast<entt::entity*>(out.data());
+
+				if constexpr (std::is_empty_v<T>) {
+					for (entt::entity entity : view)
+						*entityOut++ = entity;
+				}
+				else {
+					char* componentOut = out.data() + count * sizeof(entt::entity);
+					for (auto [entity, component] : view.each()) {
+						*entityOut++ = entity;
+						std::memcpy(componentOut, &component, sizeof(T));
+						componentOut += sizeof(T);
+					}
+				}
+				return static_cast<uint32_t>(count);
+			};
+
+			schema.load = [](entt::registry& registry, const entt::entity* entities, size_t count, const char* data) {
+				if constexpr (std::is_empty_v<T>) {
+					registry.insert<T>(entities, entities + count);
+				}
+				else {
+					// Blocks are only byte aligned inside the file
+					std::vector<T> components(count);
+					std::memcpy(components.data(), data, count * sizeof(T));
+					registry.insert<T>(entities, entities + count, components.begin());
+				}
+			};
+
+			add(std::move(schema));
+		}
+
+		// For components that carry runtime state (caches, bindings to the scene): only the Stored
+		// record is written and the version describes Stored, adding in-memory fields to T needs no
+		// bump. fromStored builds a complete component, whatever is not saved is rebuilt from it.
+		template<typename T, typename Stored>
+		static void registerComponent(std::string_view name, uint32_t version, void (*toStored)(const T&, Stored&),
+			T (*fromStored)(const Stored&), Migration<Stored> migration = nullptr) {
+			static_assert(std::is_trivially_copyable_v<Stored> && !std::is_empty_v<Stored>, "Stored records are written as raw memory");
+
+			ComponentSchema schema = makeSchema<Stored>(name, version, std::move(migration));
+
+			schema.save = [toStored](const entt::registry& registry, std::vector<char>& out) -> uint32_t {
+				auto view = registry.view<T>();
+				const size_t count = view.size();
+				out.resize(count * (sizeof(entt::entity) + sizeof(Stored)));
+				entt::entity* entityOut = reinterpret_cast<entt::entity*>(out.data());
+				char* recordOut = out.data() + count * sizeof(entt::entity);
+				for (auto [entity, component] : view.each()) {
+					*entityOut++ = entity;
+					Stored record{};
+					toStored(component, record);
+					std::memcpy(recordOut, &record, sizeof(Stored));
+					recordOut += sizeof(Stored);
+				}
+				return static_cast<uint32_t>(count);
+			};
+
+			schema.load = [fromStored](entt::registry& registry, const entt::entity* entities, size_t count, const char* data) {
+				std::vector<T> components;
+				components.reserve(count);
+				for (size_t i = 0; i < count; ++i) {
+					Stored record;
+					std::memcpy(&record, data + i * sizeof(Stored), sizeof(Stored));
+					components.push_back(fromStored(record));
+				}
+				registry.insert<T>(entities, entities + count, components.begin());
+			};
+
+			add(std::move(schema));
+		}
+
+		// All registered schemas, the engine components are registered on first use
+		static const std::vector<ComponentSchema>& schemas();
+		static const ComponentSchema* find(uint32_t id);
+
+	private:
+		// Identity and layout of the raw records of type Stored, plus the element wise migration
+		template<typename Stored>
+		static ComponentSchema makeSchema(std::string_view name, uint32_t version, Migration<Stored> migration) {
+			ComponentSchema schema;
+			schema.name = std::string(name);
+			schema.id = static_cast<uint32_t>(fnv1a64(name));
+			schema.version = version;
+			schema.size = std::is_empty_v<Stored> ? 0u : static_cast<uint32_t>(sizeof(Stored));
+			schema.layoutHash = ComponentSchema::computeLayoutHash(name, schema.size, static_cast<uint32_t>(alignof(Stored)), version);
+
+			if (migration) {
+				schema.migrate = [migration](const char* data, size_t count, uint32_t oldVersion, uint32_t oldSize, std::vector<char>& out) {
+					out.resize(count * sizeof(Stored));
+					for (size_t i = 0; i < count; ++i) {
+						Stored record{};
+						if (!migration(data + i * oldSize, oldVersion, oldSize, record))
+							return false;
+						std::memcpy(out.data() + i * sizeof(Stored), &record, sizeof(Stored));
+					}
+					return true;
+				};
+			}
+			return schema;
+		}
+
+		static void add(ComponentSchema schema);
+		static std::vector<ComponentSchema>& storage();
+	};
+}
@@ -0,0 +1,58 @@
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(ENGINE_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace engine {
+	namespace {
+		std::atomic<CpuFeatures::Simd> s_limit{ CpuFeatures::Simd::Avx2 };
+
+		CpuFeatures::Simd detect() {
+#if defined(ENGINE_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			const int maxLeaf = info[0];
+			__cpuid(info, 1);
+			// AVX and OSXSAVE, then XCR0 has to enable the SSE and AVX state
+			const bool avx = (info[2] & (1 << 28)) && (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+			if (avx && maxLeaf >= 7) {
+				__cpuidex(info, 7, 0);
+				if (info[1] & (1 << 5))
+					return CpuFeatures::Simd::Avx2;
+			}
+			return CpuFeatures::Simd::Sse2;
+#elif defined(ENGINE_SIMD_X86)
+			// libgcc / compiler-rt check the OS support for the YMM state as well
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? CpuFeatures::Simd::Avx2 : CpuFeatures::Simd::Sse2;
+#else
+			return CpuFeatures::Simd::Scalar;
+#endif
+		}
+	}
+
+	CpuFeatures::Simd CpuFeatures::detected() {
+		static const Simd level = detect();
+		return level;
+	}
+
+	CpuFeatures::Simd CpuFeatures::simd() {
+		return std::min(detected(), s_limit.load(std::memory_order_relaxed));
+	}
+
+	void CpuFeatures::limit(Simd level) {
+		s_limit.store(level, std::memory_order_relaxed);
+	}
+
+	const char* CpuFeatures::name(Simd level) {
+		switch (level) {
+		case Simd::Avx2: return "AVX2";
+		case Simd::Sse2: return "SSE2";
+		default:         return "scalar";
+		}
+	}
+}
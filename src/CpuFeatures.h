@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// x86 builds keep the SSE2 baseline. Wider kernels are compiled per function with
+// ENGINE_TARGET_AVX2 and only called when CpuFeatures::simd() reports AVX2.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SIMD_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC emits intrinsics of any instruction set without /arch
+#define ENGINE_TARGET_AVX2
+#else
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace engine {
+	// Instruction set the SIMD kernels dispatch on. Detected once through cpuid, AVX2 also needs
+	// the OS to save the YMM registers. limit() caps it, benchmarks use it to time the narrower paths.
+	class CpuFeatures {
+	public:
+		enum class Simd : uint8_t { Scalar, Sse2, Avx2 };
+
+		static Simd simd();
+		static Simd detected();
+		static void limit(Simd level);
+
+		static const char* name(Simd level);
+	};
+}
@@ -10,4 +10,7 @@ namespace engine {
 	void Debug::logError(const std::string& message, const std::source_location& loc) {
 		DebugWindow::addLog(message, 2, loc);
 	}
+	void Debug::setLogFile(const std::string& path) {
+		DebugWindow::setLogFile(path);
+	}
 }
\ No newline at end of file
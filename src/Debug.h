@@ -8,5 +8,8 @@ namespace engine {
 		static void log(const std::string& message, const std::source_location& loc = std::source_location::current());
 		static void logWarning(const std::string& message, const std::source_location& loc = std::source_location::current());
 		static void logError(const std::string& message, const std::source_location& loc = std::source_location::current());
+
+		// Mirrors every log into a file, written by the log thread. Empty path stops it.
+		static void setLogFile(const std::string& path);
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <windows.h>
 #include <filesystem>
+#include <cstring>
 
 namespace engine {
 	float DebugWindow::m_itemSpacingY = 2.0f;
@@ -14,11 +15,35 @@ namespace engine {
 	uint16_t DebugWindow::m_warningLogsCount = 0;
 	uint16_t DebugWindow::m_errorLogsCount = 0;
 
-	std::string getCurrentTimeString() {
+	LogQueue DebugWindow::s_queue;
+	std::once_flag DebugWindow::s_consumerStarted;
+	std::thread DebugWindow::s_consumer;
+	std::atomic<bool> DebugWindow::s_consumerRunning{ false };
+	std::mutex DebugWindow::s_pendingMutex;
+	std::deque<LogMessage> DebugWindow::s_pending = {};
+	std::mutex DebugWindow::s_fileMutex;
+	std::ofstream DebugWindow::s_logFile;
+	uint32_t DebugWindow::s_fileRepeats = 0;
+	LogRecord DebugWindow::s_lastRecord = {};
+
+	namespace {
+		const char* k_levelNames[3] = { "INFO", "WARNING", "ERROR" };
+
+		// Declared after the statics above so it is destroyed first and the consumer
+		// never outlives the queue
+		struct LogConsumerGuard {
+			~LogConsumerGuard() { DebugWindow::shutdown(); }
+		} s_consumerGuard;
+
+		bool sameRecord(const LogRecord& a, const LogRecord& b) {
+			return a.level == b.level && a.line == b.line && a.file == b.file && a.length == b.length && std::memcmp(a.text, b.text, a.length) == 0;
+		}
+	}
+
+	std::string getCurrentTimeString(int64_t ticks) {
 		using namespace std::chrono;
-		// 1) Hol dir jetzt und Millisekunden
-		auto now = system_clock::now();
-		auto epoch = now.time_since_epoch();
+		// 1) Zeitpunkt des Logs und Millisekunden
+		auto epoch = system_clock::duration(ticks);
 		auto ms = duration_cast<milliseconds>(epoch) % 1000;
 		auto secs = duration_cast<seconds>(epoch);
 		std::time_t t = static_cast<std::time_t>(secs.count());
@@ -48,49 +73,154 @@ namespace engine {
 		uint8_t warning,
 		const std::source_location loc)
 	{
-		if (warning == LogMessage::MESSAGE) {
-			m_messageLogsCount++;
+		std::call_once(s_consumerStarted, startConsumer);
+
+		// Formatting happens on the consumer, here only the raw record is copied
+		s_queue.push(std::chrono::system_clock::now().time_since_epoch().count(), warning, message,
+			loc.file_name(), loc.function_name(), static_cast<uint32_t>(loc.line()));
+	}
+
+	void DebugWindow::startConsumer() {
+		s_consumerRunning.store(true, std::memory_order_release);
+		s_consumer = std::thread(consumeLogs);
+	}
+
+	void DebugWindow::shutdown() {
+		if (!s_consumer.joinable())
+			return;
+
+		s_consumerRunning.store(false, std::memory_order_release);
+		s_consumer.join();
+	}
+
+	void DebugWindow::setLogFile(const std::string& path) {
+		std::lock_guard<std::mutex> lock(s_fileMutex);
+		if (s_logFile.is_open())
+			s_logFile.close();
+		if (!path.empty())
+			s_logFile.open(path, std::ios::trunc);
+	}
+
+	void DebugWindow::consumeLogs() {
+		LogRecord record;
+		for (;;) {
+			// Read the flag first, so everything pushed before shutdown() is still drained
+			const bool running = s_consumerRunning.load(std::memory_order_acquire);
+
+			bool consumed = false;
+			while (s_queue.pop(record)) {
+				consumeRecord(record);
+				consumed = true;
+			}
+
+			if (!running)
+				break;
+
+			if (!consumed) {
+				{
+					std::lock_guard<std::mutex> lock(s_fileMutex);
+					if (s_logFile.is_open())
+						s_logFile.flush();
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
 		}
-		else if (warning == LogMessage::WARNING) {
-			m_warningLogsCount++;
+
+		std::lock_guard<std::mutex> lock(s_fileMutex);
+		writeRepeatsToFile();
+		if (s_logFile.is_open())
+			s_logFile.flush();
+	}
+
+	void DebugWindow::consumeRecord(const LogRecord& record) {
+		LogMessage message(
+			std::string(record.text, record.length),
+			getCurrentTimeString(record.time),
+			record.file,
+			record.function,
+			record.level,
+			static_cast<uint16_t>(record.line)
+		);
+
+		{
+			std::lock_guard<std::mutex> lock(s_fileMutex);
+			if (s_logFile.is_open()) {
+				if (sameRecord(record, s_lastRecord)) {
+					s_fileRepeats++;
+				}
+				else {
+					writeRepeatsToFile();
+					s_logFile << "[" << message.time << "] [" << k_levelNames[std::min<uint8_t>(record.level, 2)] << "] "
+						<< message.message << " (" << message.sourcePath << ":" << message.sourceLine << ")\n";
+				}
+			}
 		}
+		s_lastRecord = record;
 
-		else if (warning == LogMessage::ERR) {
-			m_errorLogsCount++;
+		std::lock_guard<std::mutex> lock(s_pendingMutex);
+		if (!s_pending.empty() && s_pending.back().sameAs(message)) {
+			s_pending.back().count++;
+			s_pending.back().time = std::move(message.time);
+			return;
 		}
 
-		// 1) Zeit nur einmal holen
-		std::string t = getCurrentTimeString();
-
-		// 2) Emplace direkt mit Moves (keine temporären C‑Strings)
-		m_logs.emplace_back(
-			message,                // copy
-			std::move(t),           // move
-			loc.file_name(),        // string ctor
-			loc.function_name(),    // string ctor
-			warning,
-			static_cast<uint16_t>(loc.line())
-		);
-		if (m_logs.size() > s_maxLogsCount)
+		// Nobody draws the window (headless runs), keep memory bounded anyway
+		s_pending.push_back(std::move(message));
+		if (s_pending.size() > s_maxLogsCount)
+			s_pending.pop_front();
+	}
+
+	void DebugWindow::writeRepeatsToFile() {
+		if (s_fileRepeats > 0 && s_logFile.is_open())
+			s_logFile << "    (repeated " << s_fileRepeats << " more times)\n";
+		s_fileRepeats = 0;
+	}
+
+	void DebugWindow::takePendingLogs() {
+		std::deque<LogMessage> batch;
 		{
-			uint8_t warning = m_logs.front().warningState;
+			std::lock_guard<std::mutex> lock(s_pendingMutex);
+			batch.swap(s_pending);
+		}
+
+		for (auto& message : batch) {
+			if (!m_logs.empty() && m_logs.back().sameAs(message)) {
+				m_logs.back().count += message.count;
+				m_logs.back().time = std::move(message.time);
+				continue;
+			}
 
-			if (warning == LogMessage::MESSAGE)
-				m_messageLogsCount--;
+			if (message.warningState == LogMessage::MESSAGE)
+				m_messageLogsCount++;
+			else if (message.warningState == LogMessage::WARNING)
+				m_warningLogsCount++;
+			else if (message.warningState == LogMessage::ERR)
+				m_errorLogsCount++;
 
-			else if (warning == LogMessage::ERR)
-				m_errorLogsCount--;
+			m_logs.push_back(std::move(message));
+			if (m_logs.size() > s_maxLogsCount)
+			{
+				uint8_t warning = m_logs.front().warningState;
 
-			else if (warning == LogMessage::WARNING)
-				m_warningLogsCount--;
+				if (warning == LogMessage::MESSAGE)
+					m_messageLogsCount--;
 
-			m_logs.pop_front();
+				else if (warning == LogMessage::ERR)
+					m_errorLogsCount--;
+
+				else if (warning == LogMessage::WARNING)
+					m_warningLogsCount--;
+
+				m_logs.pop_front();
+			}
 		}
 	}
 
 	void DebugWindow::DrawLogLine(uint16_t i, uint16_t realIndex, const float& spacing, bool copy, std::string& clipboard) {
 		const auto& line = m_logs[i];
-		const std::string fullTxt = "[" + std::string(line.time) + "] " + std::string(line.message);
+		std::string fullTxt = "[" + std::string(line.time) + "] " + std::string(line.message);
+		if (line.count > 1)
+			fullTxt += " (x" + std::to_string(line.count) + ")";
 		bool selected = i == selectedIndex;
 
 		ImGui::PushID(i);
@@ -177,6 +307,7 @@ namespace engine {
 	}
 
 	void DebugWindow::draw() {
+		takePendingLogs();
 		if (!m_visible)
 			return;
 
@@ -274,6 +405,11 @@ namespace engine {
 
 		ImGui::Text(std::to_string(m_errorLogsCount).c_str());
 
+		if (const uint64_t dropped = s_queue.dropped(); dropped > 0) {
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Dropped: %llu", static_cast<unsigned long long>(dropped));
+		}
+
 		ImGui::SameLine();
 		ImGui::SetNextItemWidth(125.0f);
 
@@ -8,12 +8,17 @@
 #include <iostream>
 #include <string>
 #include <queue>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include "LogQueue.h"
 
 namespace engine {
 	class Window; // Forward declaration
 
 	struct LogMessage {
-		const std::string k_warningStateMessages[3] = { "Engine Debug.Log()","Engine Debug.LogWarning()", "Engine Debug.LogError()" };
+		static constexpr const char* k_warningStateMessages[3] = { "Engine Debug.Log()","Engine Debug.LogWarning()", "Engine Debug.LogError()" };
 
 		static const uint8_t MESSAGE = 0;
 		static const uint8_t WARNING = 1;
@@ -25,6 +30,11 @@ namespace engine {
 		std::string function;
 		uint8_t     warningState;
 		uint16_t    sourceLine;
+		uint32_t    count = 1;    // identical messages in a row are collapsed into one entry
+
+		bool sameAs(const LogMessage& other) const {
+			return warningState == other.warningState && sourceLine == other.sourceLine && message == other.message && sourcePath == other.sourcePath;
+		}
 
 		std::string selectedMessage() {
 			std::string result = message + "\n"
@@ -50,14 +60,27 @@ namespace engine {
 		// Default Copy/Move funktionieren jetzt optimal
 	};
 
+	// addLog only pushes a LogRecord into a lock-free queue and is safe from any thread.
+	// A background thread formats the records, collapses repeats and writes the optional
+	// log file, draw() then moves the finished messages into the window.
 	class DebugWindow {
 	public:
 		static void addLog(const std::string& log, uint8_t warning, const std::source_location loc);
 		static void draw();
 		static void setVisible(bool visible) { m_visible = visible; }
 
+		// Empty path closes the file
+		static void setLogFile(const std::string& path);
+		// Blocks until everything logged so far is formatted and written, stops the consumer
+		static void shutdown();
+
 	private:
 		static void DrawLogLine(uint16_t i, uint16_t realIndex, const float& spacing, bool copy, std::string& clipboard);
+		static void startConsumer();
+		static void consumeLogs();
+		static void consumeRecord(const LogRecord& record);
+		static void writeRepeatsToFile();
+		static void takePendingLogs();
 
 		static float m_itemSpacingY;
 		static uint16_t s_maxLogsCount;
@@ -68,5 +91,20 @@ namespace engine {
 		static uint16_t m_messageLogsCount;
 		static uint16_t m_warningLogsCount;
 		static uint16_t m_errorLogsCount;
+
+		static LogQueue s_queue;
+		static std::once_flag s_consumerStarted;
+		static std::thread s_consumer;
+		static std::atomic<bool> s_consumerRunning;
+
+		// Formatted by the consumer, waiting for the next draw()
+		static std::mutex s_pendingMutex;
+		static std::deque<LogMessage> s_pending;
+
+		static std::mutex s_fileMutex;
+		static std::ofstream s_logFile;
+		// Only touched by the consumer thread
+		static uint32_t s_fileRepeats;
+		static LogRecord s_lastRecord;
 	};
 }
@@ -6,6 +6,8 @@
 #include <Core/SceneManager.h>
 #include <Core/Window.h>
 #include <Core/ISystem.h>
+#include <Prefab.h>
+#include <EntityPool.h>
 
 // Render Components
 #include <Graphics/Camera.h>
@@ -0,0 +1,141 @@
+#include "EntityPool.h"
+#include "Components/Rigidbody2D.h"
+#include "Components/BoxCollider.h"
+#include "Components/CircleCollider.h"
+#include "Utils/Debug.h"
+#include <stdexcept>
+
+namespace engine {
+	EntityPool::EntityPool(const std::string& name) : m_name(name) {
+#ifdef ENABLE_PROFILING
+		Profiler& profiler = Profiler::Get();
+		m_activeStat = profiler.RegisterStat(("Pool " + name + " active").c_str(), StatGroup::General, StatUnit::None);
+		m_idleStat = profiler.RegisterStat(("Pool " + name + " idle").c_str(), StatGroup::General, StatUnit::None);
+		m_reusedStat = profiler.RegisterStat(("Pool " + name + " reused").c_str(), StatGroup::General, StatUnit::None, StatKind::Counter);
+#endif
+	}
+
+	EntityPool::~EntityPool() {
+		if (m_registry)
+			m_registry->on_destroy<Pooled>().disconnect<&EntityPool::onPooledDestroyed>(*this);
+	}
+
+	void EntityPool::bind(Scene& scene) {
+		entt::registry& registry = scene.registry();
+		if (m_registry == &registry) return;
+		if (m_registry)
+			throw std::runtime_error("Pool " + m_name + " is already used by another scene");
+		m_registry = &registry;
+		registry.on_destroy<Pooled>().connect<&EntityPool::onPooledDestroyed>(*this);
+	}
+
+	void EntityPool::onPooledDestroyed(entt::registry& registry, entt::entity entity) {
+		const Pooled& pooled = registry.get<Pooled>(entity);
+		if (pooled.pool != this) return;
+
+		if (pooled.active)
+			--m_active;
+		else
+			std::erase(m_idle, entity);
+		publishStats();
+	}
+
+	void EntityPool::prewarm(Scene& scene, size_t count) {
+		bind(scene);
+		m_spawned.clear();
+		if (m_prefab.has<Transform2D>()) {
+			m_prefab.instantiate(scene, count, m_spawned);
+		}
+		else {
+			// Colliders are built from the transform, parked ones wait at the origin
+			const std::vector<Transform2D> parked(count);
+			m_prefab.instantiate(scene, parked, m_spawned);
+		}
+		entt::registry& registry = scene.registry();
+		for (entt::entity entity : m_spawned) {
+			registry.emplace<Pooled>(entity, this, false);
+			setActive(scene, entity, false);
+		}
+		m_idle.insert(m_idle.end(), m_spawned.begin(), m_spawned.end());
+		publishStats();
+	}
+
+	entt::entity EntityPool::acquire(Scene& scene, const Transform2D& transform) {
+		bind(scene);
+		entt::registry& registry = scene.registry();
+
+		entt::entity entity;
+		if (m_idle.empty()) {
+			m_spawned.clear();
+			m_prefab.instantiate(scene, std::span(&transform, 1), m_spawned);
+			entity = m_spawned.front();
+			registry.emplace<Pooled>(entity, this, true);
+		}
+		else {
+			entity = m_idle.back();
+			m_idle.pop_back();
+			registry.get<Pooled>(entity).active = true;
+			// Flags the teleport, the physics pass moves the body before the next step
+			registry.get<Transform2D>(entity).set(transform.position(), transform.scale(), transform.rotation());
+			setActive(scene, entity, true);
+#ifdef ENABLE_PROFILING
+			Profiler::Get().AddStat(m_reusedStat, 1.0);
+#endif
+		}
+
+		++m_active;
+		publishStats();
+		return entity;
+	}
+
+	void EntityPool::release(Scene& scene, entt::entity entity) {
+		entt::registry& registry = scene.registry();
+		Pooled* pooled = registry.valid(entity) ? registry.try_get<Pooled>(entity) : nullptr;
+		if (pooled == nullptr || pooled->pool != this) {
+			Debug::logWarning("Pool " + m_name + ": released an entity that was not acquired from it");
+			return;
+		}
+		if (!pooled->active) return;
+
+		pooled->active = false;
+		setActive(scene, entity, false);
+		m_idle.push_back(entity);
+		--m_active;
+		publishStats();
+	}
+
+	void EntityPool::setActive(Scene& scene, entt::entity entity, bool active) {
+		entt::registry& registry = scene.registry();
+		if (active) registry.remove<Inactive>(entity);
+		else registry.emplace<Inactive>(entity);
+
+		if (Rigidbody2D* rb = registry.try_get<Rigidbody2D>(entity)) {
+			rb->enable(active);
+			// After enabling, a disabled body ignores velocity changes
+			if (active) {
+				rb->setVelocity({ 0.f, 0.f });
+				rb->setAngularVelocity(0.f);
+			}
+		}
+		else {
+			// Without a rigidbody the collider owns a static body that nothing else moves
+			const Transform2D* transform = registry.try_get<Transform2D>(entity);
+			if (BoxCollider* box = registry.try_get<BoxCollider>(entity)) {
+				if (active && transform) box->setBodyTransform(*transform);
+				box->enable(active);
+			}
+			if (CircleCollider* circle = registry.try_get<CircleCollider>(entity)) {
+				if (active && transform) circle->setBodyTransform(*transform);
+				circle->enable(active);
+			}
+		}
+	}
+
+	void EntityPool::publishStats() {
+#ifdef ENABLE_PROFILING
+		Profiler& profiler = Profiler::Get();
+		profiler.SetStat(m_activeStat, static_cast<double>(m_active));
+		profiler.SetStat(m_idleStat, static_cast<double>(m_idle.size()));
+#endif
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <string>
+#include <vector>
+#include "Prefab.h"
+#include "Inactive.h"
+#include "Core/Profiler.h"
+
+namespace engine {
+	class EntityPool;
+
+	// Added to every entity a pool creates, release() ignores entities of other pools
+	struct Pooled {
+		const EntityPool* pool = nullptr;
+		bool active = false;
+	};
+
+	// Recycles instances of a prefab for objects that are spawned and despawned all the time
+	// (projectiles, items, obstacles). Released entities are tagged Inactive and their bodies are
+	// disabled instead of being destroyed, acquiring one re-enables it at the new transform, so
+	// neither side touches Box2D body creation or the entt pools.
+	// Shows up in the profiler as "Pool <name> active/idle/reused".
+	// A pool serves one scene and has to be destroyed before it, as a member of one of the
+	// scene's systems it is. Pooled entities destroyed by other code are dropped from the counts.
+	class EntityPool {
+	public:
+		explicit EntityPool(const std::string& name);
+		~EntityPool();
+
+		EntityPool(const EntityPool&) = delete;
+		EntityPool& operator=(const EntityPool&) = delete;
+
+		// Describe the pooled entity before the first acquire
+		Prefab& prefab() { return m_prefab; }
+
+		// Creates count parked instances in one batch, at the prefab's Transform2D or the origin
+		void prewarm(Scene& scene, size_t count);
+		entt::entity acquire(Scene& scene, const Transform2D& transform);
+		// Entities that did not come from this pool or are already released are ignored
+		void release(Scene& scene, entt::entity entity);
+
+		size_t activeCount() const { return m_active; }
+		size_t idleCount() const { return m_idle.size(); }
+
+	private:
+		void bind(Scene& scene);
+		void onPooledDestroyed(entt::registry& registry, entt::entity entity);
+		void setActive(Scene& scene, entt::entity entity, bool active);
+		void publishStats();
+
+		std::string m_name;
+		entt::registry* m_registry = nullptr;
+		Prefab m_prefab;
+		std::vector<entt::entity> m_idle;
+		std::vector<entt::entity> m_spawned;
+		size_t m_active = 0;
+		StatId m_activeStat;
+		StatId m_idleStat;
+		StatId m_reusedStat;
+	};
+}
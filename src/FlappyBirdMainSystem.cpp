@@ -24,13 +24,8 @@ namespace engine {
 
 		glm::vec2 scale = TextureManager::getTexture(pipe).sizeNormalized()  *10.f;
 
-		entt::entity borderHandle = scene.createRenderableEntity(Transform2D::FromPositionScaleRotation({ m_nextPipePositionX ,posY + dst }, scale, 180.f), SpriteRenderer::create(pipe, 1, { 1.f,1.f,1.f,1.f }));
-		scene.addComponent<BoxCollider>(borderHandle).registerContacts(true);
-		scene.addComponent<Deadly>(borderHandle);
-
-		entt::entity borderHandle_2 = scene.createRenderableEntity(Transform2D::FromPositionScale({ m_nextPipePositionX ,posY - dst }, scale), SpriteRenderer::create(pipe, 1, { 1.f,1.f,1.f,1.f }));
-		scene.addComponent<BoxCollider>(borderHandle_2).registerContacts(true);
-		scene.addComponent<Deadly>(borderHandle_2);
+		m_pipes.push_back(m_pipePool.acquire(scene, Transform2D::FromPositionScaleRotation({ m_nextPipePositionX ,posY + dst }, scale, 180.f)));
+		m_pipes.push_back(m_pipePool.acquire(scene, Transform2D::FromPositionScale({ m_nextPipePositionX ,posY - dst }, scale)));
 
 		m_nextPipePositionX += rnd::next(5.f, 10.f);
 	}
@@ -57,6 +52,13 @@ namespace engine {
 
 		if (m_nextPipePositionX - m_playerRigidbody->getPosition().x <= 100)
 			CreatePipe(scene);
+
+		// Pipes behind the camera go back to the pool and come back as the next ones ahead
+		const float despawnX = m_camera->transform->position().x - m_camera->worldViewPort().x;
+		while (!m_pipes.empty() && scene.getComponent<Transform2D>(m_pipes.front()).position().x < despawnX) {
+			m_pipePool.release(scene, m_pipes.front());
+			m_pipes.pop_front();
+		}
 	}
 
 	void FlappyBirdMainSystem::fixedUpdate(Scene& scene) {
@@ -70,7 +72,7 @@ namespace engine {
 		target.x = unclampedTarget.x;
 		target.y = std::clamp<float>(unclampedTarget.y, -5.f + viewportHalfSize.y, 15.f - viewportHalfSize.y);
 
-		m_camera->transform->position = glm::mix(m_camera->transform->position, target, t);
+		m_camera->transform->setPosition(glm::mix(m_camera->transform->position(), target, t));
 	}
 
 	void OnBeginContact(const b2ContactBeginTouchEvent& e) {
@@ -101,6 +103,10 @@ namespace engine {
 		auto texHandles = TextureManager::getLoadedHandles();
 
 		pipe = texHandles[0];
+		m_pipePool.prefab()
+			.with<SpriteRenderer>(SpriteRenderer::create(pipe, 1, { 1.f,1.f,1.f,1.f }))
+			.with<Deadly>()
+			.attach<BoxCollider>([](BoxCollider& collider) { collider.registerContacts(true); });
 		for (int i = 0; i < 3; i++) {
 			playerSprites[i] = texHandles[1 + i];
 		}
@@ -127,6 +133,6 @@ namespace engine {
 		collider.registerContacts(true);
 		collider.onCollisionEnter(scene, OnBeginContact);
 
-		tr.scale = TextureManager::getTexture(playerSprites[0]).sizeNormalized();
+		tr.setScale(TextureManager::getTexture(playerSprites[0]).sizeNormalized());
 	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "EngineMain.h"
+#include <deque>
 
 namespace engine {
 	class FlappyBirdMainSystem : public ISystem {
@@ -21,5 +22,8 @@ namespace engine {
 
 		Rigidbody2D* m_playerRigidbody;
 		float m_nextPipePositionX = 10.f;
+		EntityPool m_pipePool{ "Pipes" };
+		// Oldest first, released once they are behind the camera
+		std::deque<entt::entity> m_pipes;
 	};
 }
\ No newline at end of file
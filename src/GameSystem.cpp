@@ -20,7 +20,7 @@ namespace engine {
 		if (box) {
 			BoxCollider& boxCollider = scene.addComponent<BoxCollider>(entity, scene);
 			sp.texture = texHandles[rndm::Next(0, texHandles.size() - 1)];
-			tr.scale = tr.scale * graphics::TextureManager::getTexture(sp.texture).sizeNormalized();
+			tr.setScale(tr.scale() * graphics::TextureManager::getTexture(sp.texture).sizeNormalized());
 			boxCollider.updateScale(scene);
 		}
 		else {
@@ -44,7 +44,7 @@ namespace engine {
 
 
 		if (entities.size() > 0 && scene.isValid(entities.back()))
-			graphics::Gizmos::drawLine(scene.getComponent<Transform2D>(entities.back()).position, worldMousePos);
+			graphics::Gizmos::drawLine(scene.getComponent<Transform2D>(entities.back()).position(), worldMousePos);
 
 		graphics::Gizmos::color = { 0.f, scene.name() == "World 1" ? 1.f : 0.f, scene.name() != "World 1" ? 1.f : 0.f, 1.f };
 
@@ -63,10 +63,10 @@ namespace engine {
 				AddPhysicsEntity(scene, worldMousePos);
 		}
 		if (Input::getMouseButton(2)) {
-			auto rbView = registry.view<Rigidbody2D, Transform2D>();
+			auto rbView = registry.view<Rigidbody2D, Transform2D>(entt::exclude<Inactive>);
 
 			for (auto [ent, rb, tr] : rbView.each()) {
-				glm::vec2 dir = worldMousePos - tr.position;
+				glm::vec2 dir = worldMousePos - tr.position();
 				rb.setVelocity(dir);
 			}
 		}
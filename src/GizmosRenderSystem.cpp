@@ -21,10 +21,10 @@ namespace graphics {
 		Gizmos::color = engine::DebugSettings::Get().colliderColor;
 
 		if (Gizmos::drawCollider) {
-			for (auto [ent, boxCollider, tr] : registry.view<engine::BoxCollider, engine::Transform2D>().each()) {
+			for (auto [ent, boxCollider, tr] : registry.view<engine::BoxCollider, engine::Transform2D>(entt::exclude<engine::Inactive>).each()) {
 				boxCollider.debugDraw();
 			}
-			for (auto [ent, circleCollider, tr] : registry.view<engine::CircleCollider, engine::Transform2D>().each()) {
+			for (auto [ent, circleCollider, tr] : registry.view<engine::CircleCollider, engine::Transform2D>(entt::exclude<engine::Inactive>).each()) {
 				circleCollider.debugDraw();
 			}
 		}
@@ -32,9 +32,11 @@ namespace graphics {
 		Gizmos::color = engine::DebugSettings::Get().aabbColor;
 
 		if (Gizmos::aabb) {
-			for (auto [ent, tr, spr] : registry.view<engine::Transform2D, SpriteRenderer>().each()) {
-				Gizmos::drawBox(tr.position, AABB::create(tr).scale(), 0.f);
-			}
+			// Last frame's viewport, the index only hands out what can pass the gizmo culling anyway
+			scene.spatialIndex().queryRect(Gizmos::camViewportAABB, [&](entt::entity ent, const AABB& bounds) {
+				if (registry.all_of<SpriteRenderer>(ent))
+					Gizmos::drawBox((bounds.min + bounds.max) * 0.5f, bounds.scale(), 0.f);
+			});
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include "Components/Transform.h"
+
+namespace engine {
+	// Parent/child links plus the transform relative to the parent. Scene maintains the links
+	// (Scene::setParent), the world Transform2D of a child is written by the propagation pass
+	// and should not be set directly, move children through the local setters instead.
+	// World = parent position + parent rotation * (parent scale * local position), rotations
+	// add up and scales multiply, so non-uniform scale under a rotated parent does not shear.
+	// The local setters record the entity in the scene's transform change list, the pass only
+	// walks the subtrees below recorded entities.
+	struct Hierarchy {
+		entt::entity parent{ entt::null };
+		entt::entity firstChild{ entt::null };
+		entt::entity nextSibling{ entt::null };
+		entt::entity prevSibling{ entt::null };
+		uint32_t depth{ 0 };        // 0 for roots, the propagation pass starts with the shallowest nodes
+		uint32_t childCount{ 0 };
+
+		const glm::vec2& localPosition() const { return m_localPosition; }
+		const glm::vec2& localScale() const { return m_localScale; }
+		float localRotation() const { return m_localRotation; }   // Radians
+
+		void setLocalPosition(const glm::vec2& position) { m_localPosition = position; markLocalDirty(); }
+		void setLocalScale(const glm::vec2& scale) { m_localScale = scale; markLocalDirty(); }
+		void setLocalRotation(float degrees) { setLocalRotationRadians(glm::radians(degrees)); }
+		void setLocalRotationRadians(float radians) { m_localRotation = radians; markLocalDirty(); }
+
+	private:
+		void markLocalDirty() {
+			if (!m_localDirty)
+				TransformChangeList::record(m_changeList, m_entity);
+			m_localDirty = true;
+		}
+
+		glm::vec2 m_localPosition{ 0.f };
+		glm::vec2 m_localScale{ 1.f };
+		float m_localRotation{ 0.f };
+		uint32_t m_parentVersion{ 0 };   // Parent Transform2D::version() the world transform was built from
+		bool m_localDirty{ true };
+		uint32_t m_changeList{ 0 };      // Bound by Scene when the component is added
+		uint32_t m_entity{ 0 };
+
+		friend class Scene;
+	};
+}
@@ -1,12 +1,49 @@
 #pragma once
 
 #include "entt/entt.hpp"
+#include <string>
+#include <algorithm>
+#include <cstdint>
 
 namespace engine {
     class Scene;  // Forward declaration
 }
 
 namespace engine {
+    // Timing of one system callback, Scene records every call and publishes the
+    // window values to the profiler once per second
+    struct SystemTiming {
+        double lastMs = 0.0;
+        double avgMs = 0.0;
+        double worstMs = 0.0;
+        double allTimeWorstMs = 0.0;
+        uint32_t callsPerSecond = 0;
+        uint64_t calls = 0;
+
+        void record(double ms) {
+            lastMs = ms;
+            calls++;
+            allTimeWorstMs = std::max(allTimeWorstMs, ms);
+            m_windowMs += ms;
+            m_windowWorstMs = std::max(m_windowWorstMs, ms);
+            m_windowCalls++;
+        }
+
+        void publishWindow() {
+            avgMs = m_windowCalls > 0 ? m_windowMs / m_windowCalls : 0.0;
+            worstMs = m_windowWorstMs;
+            callsPerSecond = m_windowCalls;
+            m_windowMs = 0.0;
+            m_windowWorstMs = 0.0;
+            m_windowCalls = 0;
+        }
+
+    private:
+        double m_windowMs = 0.0;
+        double m_windowWorstMs = 0.0;
+        uint32_t m_windowCalls = 0;
+    };
+
     class ISystem {
     public:
         virtual void update(Scene& scene) {}
@@ -18,8 +55,18 @@ namespace engine {
         bool enabled() { return m_enabled; }
         virtual ~ISystem() = default;
 
+        // Type name of the system, set by Scene when the system is added
+        const std::string& name() const { return m_name; }
+        const SystemTiming& updateTiming() const { return m_updateTiming; }
+        const SystemTiming& fixedUpdateTiming() const { return m_fixedUpdateTiming; }
+
     private:
         bool m_enabled = true;
+        std::string m_name;
+        const char* m_updateZone = "";
+        const char* m_fixedUpdateZone = "";
+        SystemTiming m_updateTiming;
+        SystemTiming m_fixedUpdateTiming;
 
         friend class Scene;
     };
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace engine {
+	// Tag for entities parked in an EntityPool. They keep their components but leave the spatial
+	// index (and with it rendering) and their bodies are disabled. Systems that should skip them
+	// iterate with entt::exclude<Inactive>.
+	struct Inactive {};
+}
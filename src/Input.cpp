@@ -1,80 +1,121 @@
 #include "Input.h"
+#include "InputRecorder.h"
 
 namespace engine {
 	GLFWwindow* Input::s_window = nullptr;
 
-	bool Input::s_currentKeyStates[Input::k_keyCount] = { false };
-	bool Input::s_previousKeyStates[Input::k_keyCount] = { false };
-	bool Input::s_currentMouseButtonStates[Input::k_mouseButtonCount] = { false };
-	bool Input::s_previousMouseButtonStates[Input::k_mouseButtonCount] = { false };
+	std::bitset<Input::k_keyCount> Input::s_currentKeys;
+	std::bitset<Input::k_keyCount> Input::s_previousKeys;
+	std::bitset<Input::k_mouseButtonCount> Input::s_currentMouseButtons;
+	std::bitset<Input::k_mouseButtonCount> Input::s_previousMouseButtons;
 	bool Input::s_active = true;
 
+	Input::State Input::s_live;
+	std::bitset<Input::k_keyCount> Input::s_pressedKeys;
+	std::bitset<Input::k_mouseButtonCount> Input::s_pressedMouseButtons;
+
 	float Input::s_scrollValue = { 0 };
 	glm::vec2 Input::s_mouseAxis = { 0, 0 };
 	glm::vec2 Input::s_mousePosition{ 0.f };
 
-	void Input::updateKeyStates() {
-		if (!s_active)return;
+	void Input::init(GLFWwindow* window) {
+		s_window = window;
+		glfwSetKeyCallback(window, keyCallback);
+		glfwSetMouseButtonCallback(window, mouseButtonCallback);
+		glfwSetCursorPosCallback(window, cursorPositionCallback);
+
+		double x, y;
+		glfwGetCursorPos(window, &x, &y);
+		s_live.mousePosition = { x, -y };
+		s_mousePosition = s_live.mousePosition;
+	}
 
-		std::copy(std::begin(s_currentKeyStates), std::end(s_currentKeyStates), std::begin(s_previousKeyStates));
-		std::copy(std::begin(s_currentMouseButtonStates), std::end(s_currentMouseButtonStates), std::begin(s_previousMouseButtonStates));
+	void Input::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+		// GLFW_KEY_UNKNOWN is -1
+		if (key < 0 || key >= k_keyCount) return;
 
-		for (int key = 0; key <= GLFW_KEY_LAST; ++key) {
-			s_currentKeyStates[key] = (glfwGetKey(s_window, key) == GLFW_PRESS);
+		if (action == GLFW_PRESS) {
+			s_live.keys.set(key);
+			s_pressedKeys.set(key);
 		}
-
-		for (int key = 0; key <= 7; ++key) {
-			s_currentMouseButtonStates[key] = (glfwGetMouseButton(s_window, key) == GLFW_PRESS);
+		else if (action == GLFW_RELEASE) {
+			s_live.keys.reset(key);
 		}
+	}
 
+	void Input::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+		if (button < 0 || button >= k_mouseButtonCount) return;
 
-		double x, y;
-		glfwGetCursorPos(s_window, &x, &y);
-		glm::vec2 currentMouseAxis = { x, -y };
-
-		s_mousePosition = currentMouseAxis;
-		static glm::vec2 lastMousePos = currentMouseAxis;
+		if (action == GLFW_PRESS) {
+			s_live.mouseButtons.set(button);
+			s_pressedMouseButtons.set(button);
+		}
+		else if (action == GLFW_RELEASE) {
+			s_live.mouseButtons.reset(button);
+		}
+	}
 
-		s_mouseAxis = lastMousePos - currentMouseAxis;
-		lastMousePos = currentMouseAxis;
+	void Input::cursorPositionCallback(GLFWwindow* window, double x, double y) {
+		s_live.mousePosition = { x, -y };
+	}
 
-		static float lastScrollvalue = 0;
-		if (lastScrollvalue == s_scrollValue)
-			s_scrollValue = 0;
+	void Input::onScroll(float offset) {
+		s_live.scroll += offset;
+	}
 
-		lastScrollvalue = s_scrollValue;
+	void Input::updateKeyStates() {
+		State state = s_live;
+		state.keys |= s_pressedKeys;
+		state.mouseButtons |= s_pressedMouseButtons;
+		s_pressedKeys.reset();
+		s_pressedMouseButtons.reset();
+		s_live.scroll = 0.f;
+
+		// Records the frame, or replaces it with the recorded one while replaying
+		InputRecorder::latch(state);
+
+		if (!s_active) return;
+
+		s_previousKeys = s_currentKeys;
+		s_currentKeys = state.keys;
+		s_previousMouseButtons = s_currentMouseButtons;
+		s_currentMouseButtons = state.mouseButtons;
+
+		s_mouseAxis = s_mousePosition - state.mousePosition;
+		s_mousePosition = state.mousePosition;
+		s_scrollValue = state.scroll;
 	}
 
 	bool Input::getKey(KeyCode keyCode) {
 		int key = static_cast<int>(keyCode);
 		if (key < 0 || key > GLFW_KEY_LAST) return false;
-		return s_currentKeyStates[key];
+		return s_currentKeys[key];
 	}
 
 	bool Input::getKeyDown(KeyCode keyCode) {
 		int key = static_cast<int>(keyCode);
 		if (key < 0 || key > GLFW_KEY_LAST) return false;
-		return s_currentKeyStates[key] && !s_previousKeyStates[key];
+		return s_currentKeys[key] && !s_previousKeys[key];
 	}
 
 	bool Input::getKeyUp(KeyCode keyCode) {
 		int key = static_cast<int>(keyCode);
 		if (key < 0 || key > GLFW_KEY_LAST) return false;
-		return !s_currentKeyStates[key] && s_previousKeyStates[key];
+		return !s_currentKeys[key] && s_previousKeys[key];
 	}
 
 	bool Input::getMouseButton(int mouseButton) {
 		if (mouseButton < 0 || mouseButton >= k_mouseButtonCount) return false;
-		return s_currentMouseButtonStates[mouseButton];
+		return s_currentMouseButtons[mouseButton];
 	}
 
 	bool Input::getMouseButtonDown(int mouseButton) {
 		if (mouseButton < 0 || mouseButton >= k_mouseButtonCount) return false;
-		return s_currentMouseButtonStates[mouseButton] && !s_previousMouseButtonStates[mouseButton];
+		return s_currentMouseButtons[mouseButton] && !s_previousMouseButtons[mouseButton];
 	}
 
 	bool Input::getMouseButtonUp(int mouseButton) {
 		if (mouseButton < 0 || mouseButton >= k_mouseButtonCount) return false;
-		return !s_currentMouseButtonStates[mouseButton] && s_previousMouseButtonStates[mouseButton];
+		return !s_currentMouseButtons[mouseButton] && s_previousMouseButtons[mouseButton];
 	}
 }
\ No newline at end of file
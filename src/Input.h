@@ -4,6 +4,7 @@
 
 //std
 #include <vector>
+#include <bitset>
 
 namespace engine {
     enum class KeyCode {
@@ -135,8 +136,20 @@ namespace engine {
 	class Input {
 		friend class Application;
 		friend class Window;
+		friend class InputRecorder;
 
 	public:
+		static const int k_keyCount = GLFW_KEY_LAST + 1;
+		static const int k_mouseButtonCount = 8;
+
+		// Everything the game sees of the input in one frame, this is what gets recorded and replayed
+		struct State {
+			std::bitset<k_keyCount> keys;
+			std::bitset<k_mouseButtonCount> mouseButtons;
+			glm::vec2 mousePosition{ 0.f };
+			float scroll = 0.f;
+		};
+
 		/*Returns whether the key is pressed down*/
 		static bool getKey(KeyCode keyCode);
 		/*Returns whether the key was pressed down this frame*/
@@ -158,21 +171,31 @@ namespace engine {
 		static void active(bool active) { s_active = active; }
 
 	private:
+		// Installs the GLFW callbacks, has to run before ImGui so ImGui chains to them
+		static void init(GLFWwindow* window);
 		static void updateKeyStates();
 
+		static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+		static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+		static void cursorPositionCallback(GLFWwindow* window, double x, double y);
+		static void onScroll(float offset);
+
 		static bool s_active;
 		static GLFWwindow* s_window;
-		static const int k_keyCount = GLFW_KEY_LAST + 1;
-		static const int k_mouseButtonCount = 8;
 
 		static float s_scrollValue;
 		static glm::vec2 s_mouseAxis;
 		static glm::vec2 s_mousePosition;
 
-		static bool s_currentKeyStates[k_keyCount];
-		static bool s_previousKeyStates[k_keyCount];
+		static std::bitset<k_keyCount> s_currentKeys;
+		static std::bitset<k_keyCount> s_previousKeys;
+		static std::bitset<k_mouseButtonCount> s_currentMouseButtons;
+		static std::bitset<k_mouseButtonCount> s_previousMouseButtons;
 
-		static bool s_currentMouseButtonStates[k_mouseButtonCount];
-		static bool s_previousMouseButtonStates[k_mouseButtonCount];
+		// Written by the callbacks between two frames. Pressed bits keep a press that is
+		// released again before the next frame visible for one frame.
+		static State s_live;
+		static std::bitset<k_keyCount> s_pressedKeys;
+		static std::bitset<k_mouseButtonCount> s_pressedMouseButtons;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "InputRecorder.h"
+#include "Utils/Debug.h"
+#include "Utils/randomr.h"
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace engine {
+	InputRecorder::Mode InputRecorder::s_mode = InputRecorder::Mode::Off;
+	FILE* InputRecorder::s_file = nullptr;
+	uint64_t InputRecorder::s_frame = 0;
+	float InputRecorder::s_deltaSeconds = 0.f;
+	bool InputRecorder::s_quitWhenDone = false;
+	Input::State InputRecorder::s_state;
+
+	namespace {
+		template<typename T>
+		void write(FILE* file, const T& value) {
+			std::fwrite(&value, sizeof(T), 1, file);
+		}
+
+		template<typename T>
+		bool read(FILE* file, T& value) {
+			return std::fread(&value, sizeof(T), 1, file) == 1;
+		}
+	}
+
+	void InputRecorder::startRecording(const std::filesystem::path& path, uint64_t seed) {
+		stopRecording();
+		stopReplay();
+
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, path.c_str(), L"wb") != 0) file = nullptr;
+#else
+		file = std::fopen(path.c_str(), "wb");
+#endif
+		if (!file)
+			throw std::runtime_error("Could not open input recording " + path.string());
+		std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+		if (seed == 0)
+			seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+		rnd::seed(seed);
+
+		write(file, Header{ k_magic, k_version, seed });
+		s_file = file;
+		s_mode = Mode::Recording;
+		s_frame = 0;
+		// Everything counts as changed in the first frame
+		s_state = Input::State{};
+		s_state.mousePosition = glm::vec2(std::numeric_limits<float>::quiet_NaN());
+		Debug::log("Recording input to " + path.string());
+	}
+
+	void InputRecorder::stopRecording() {
+		if (s_mode != Mode::Recording) return;
+		close();
+		Debug::log("Input recording stopped after " + std::to_string(s_frame) + " frames");
+	}
+
+	void InputRecorder::startReplay(const std::filesystem::path& path, bool quitWhenDone) {
+		stopRecording();
+		stopReplay();
+
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+		file = std::fopen(path.c_str(), "rb");
+#endif
+		if (!file)
+			throw std::runtime_error("Could not open input recording " + path.string());
+		std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+		Header header{};
+		if (!read(file, header) || header.magic != k_magic || header.version > k_version) {
+			std::fclose(file);
+			throw std::runtime_error("Invalid input recording " + path.string());
+		}
+		rnd::seed(header.seed);
+
+		s_file = file;
+		s_mode = Mode::Replaying;
+		s_frame = 0;
+		s_quitWhenDone = quitWhenDone;
+		s_state = Input::State{};
+		Debug::log("Replaying input from " + path.string());
+	}
+
+	void InputRecorder::stopReplay() {
+		if (s_mode != Mode::Replaying) return;
+		close();
+		Debug::log("Input replay finished after " + std::to_string(s_frame) + " frames");
+		if (s_quitWhenDone && Input::s_window)
+			glfwSetWindowShouldClose(Input::s_window, GLFW_TRUE);
+	}
+
+	void InputRecorder::close() {
+		if (s_file)
+			std::fclose(s_file);
+		s_file = nullptr;
+		s_mode = Mode::Off;
+	}
+
+	void InputRecorder::beginFrame(float& deltaSeconds) {
+		if (s_mode == Mode::Recording) {
+			s_deltaSeconds = deltaSeconds;
+		}
+		else if (s_mode == Mode::Replaying) {
+			if (!readFrame()) {
+				stopReplay();
+				return;
+			}
+			deltaSeconds = s_deltaSeconds;
+		}
+	}
+
+	bool InputRecorder::readFrame() {
+		uint8_t flags = 0;
+		if (!read(s_file, flags) || !read(s_file, s_deltaSeconds))
+			return false;
+
+		if (flags & KeysChanged) {
+			for (int word = 0; word < k_keyWords; ++word) {
+				uint64_t bits = 0;
+				if (!read(s_file, bits)) return false;
+				for (int bit = 0; bit < 64 && word * 64 + bit < Input::k_keyCount; ++bit)
+					s_state.keys[word * 64 + bit] = (bits >> bit) & 1;
+			}
+		}
+		if (flags & MouseButtonsChanged) {
+			uint8_t buttons = 0;
+			if (!read(s_file, buttons)) return false;
+			s_state.mouseButtons = std::bitset<Input::k_mouseButtonCount>(buttons);
+		}
+		if (flags & MousePositionChanged) {
+			if (!read(s_file, s_state.mousePosition.x) || !read(s_file, s_state.mousePosition.y)) return false;
+		}
+		s_state.scroll = 0.f;
+		if (flags & Scrolled) {
+			if (!read(s_file, s_state.scroll)) return false;
+		}
+		return true;
+	}
+
+	void InputRecorder::latch(Input::State& state) {
+		if (s_mode == Mode::Replaying) {
+			state = s_state;
+			++s_frame;
+			return;
+		}
+		if (s_mode != Mode::Recording)
+			return;
+
+		uint8_t flags = 0;
+		if (state.keys != s_state.keys) flags |= KeysChanged;
+		if (state.mouseButtons != s_state.mouseButtons) flags |= MouseButtonsChanged;
+		if (!(state.mousePosition == s_state.mousePosition)) flags |= MousePositionChanged;
+		if (state.scroll != 0.f) flags |= Scrolled;
+
+		write(s_file, flags);
+		write(s_file, s_deltaSeconds);
+		if (flags & KeysChanged) {
+			for (int word = 0; word < k_keyWords; ++word) {
+				uint64_t bits = 0;
+				for (int bit = 0; bit < 64 && word * 64 + bit < Input::k_keyCount; ++bit)
+					bits |= static_cast<uint64_t>(state.keys[word * 64 + bit]) << bit;
+				write(s_file, bits);
+			}
+		}
+		if (flags & MouseButtonsChanged)
+			write(s_file, static_cast<uint8_t>(state.mouseButtons.to_ulong()));
+		if (flags & MousePositionChanged) {
+			write(s_file, state.mousePosition.x);
+			write(s_file, state.mousePosition.y);
+		}
+		if (flags & Scrolled)
+			write(s_file, state.scroll);
+
+		s_state = state;
+		++s_frame;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Input.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+namespace engine {
+	// Records the latched input of every frame together with the frame delta time and the
+	// rnd seed, and feeds it back in instead of the live input. A replayed session produces
+	// the same frames as the original run, live input is ignored while replaying.
+	//
+	// File layout: header (magic "EINP", version, seed), then one record per frame:
+	//   uint8 flags, float deltaSeconds, then only the parts that changed since the last frame
+	//   (key bitset words, mouse buttons, mouse position, scroll).
+	class InputRecorder {
+		friend class Input;
+
+	public:
+		// Reseeds rnd with seed (a random one if 0) so the session can be replayed
+		static void startRecording(const std::filesystem::path& path, uint64_t seed = 0);
+		static void stopRecording();
+
+		// Reseeds rnd with the recorded seed. With quitWhenDone the window closes after the last frame
+		static void startReplay(const std::filesystem::path& path, bool quitWhenDone = false);
+		static void stopReplay();
+
+		static bool isRecording() { return s_mode == Mode::Recording; }
+		static bool isReplaying() { return s_mode == Mode::Replaying; }
+		static uint64_t frame() { return s_frame; }
+
+		// Called by the application right after measuring the frame time, replaces it while replaying
+		static void beginFrame(float& deltaSeconds);
+
+	private:
+		enum class Mode : uint8_t { Off, Recording, Replaying };
+
+		enum Flags : uint8_t {
+			KeysChanged = 1 << 0,
+			MouseButtonsChanged = 1 << 1,
+			MousePositionChanged = 1 << 2,
+			Scrolled = 1 << 3
+		};
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t seed;
+		};
+
+		static constexpr uint32_t k_magic = 0x504E4945; // "EINP"
+		static constexpr uint32_t k_version = 1;
+		static constexpr int k_keyWords = (Input::k_keyCount + 63) / 64;
+
+		// Called by Input when the frame state is latched
+		static void latch(Input::State& state);
+
+		static bool readFrame();
+		static void close();
+
+		static Mode s_mode;
+		static FILE* s_file;
+		static uint64_t s_frame;
+		static float s_deltaSeconds;
+		static bool s_quitWhenDone;
+		// Last written state while recording, next state to apply while replaying
+		static Input::State s_state;
+	};
+}
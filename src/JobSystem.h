@@ -8,6 +8,9 @@
 #include <functional>
 #include <future>
 #include <atomic>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
 
 class ThreadPool {
 public:
@@ -23,6 +26,65 @@ public:
         shutdown();
     }
 
+    // Gemeinsamer Pool der Engine, ein Thread bleibt fr den Main-Thread frei
+    static ThreadPool& global() {
+        static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    size_t threadCount() const { return workers.size(); }
+
+    // 4) fn(i) fr alle i in [0, count) auf den Workern, der Aufrufer arbeitet mit.
+    //    Gewartet wird nur auf die Indizes, nicht auf die Helfer-Tasks, daher ist der Aufruf
+    //    auch aus einem Worker heraus mglich. Die erste Exception wird weitergeworfen.
+    template<typename F>
+    void parallelFor(size_t count, F&& fn) {
+        if (count == 0) return;
+
+        struct State {
+            std::atomic<size_t> next{ 0 };
+            size_t done = 0;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<State>();
+        auto* body = &fn;
+
+        // Spt startende Helfer finden keinen Index mehr und fassen body nicht an
+        auto run = [state, count, body] {
+            size_t finished = 0;
+            for (size_t i; (i = state->next.fetch_add(1, std::memory_order_relaxed)) < count; ++finished) {
+                try {
+                    (*body)(i);
+                }
+                catch (...) {
+                    std::lock_guard lock(state->mutex);
+                    if (!state->error) state->error = std::current_exception();
+                }
+            }
+            if (finished > 0) {
+                std::lock_guard lock(state->mutex);
+                state->done += finished;
+                if (state->done == count) state->cv.notify_all();
+            }
+        };
+
+        const size_t helpers = std::min(workers.size(), count - 1);
+        try {
+            for (size_t i = 0; i < helpers; ++i)
+                schedule(run);
+        }
+        catch (const std::runtime_error&) {
+            // Pool bereits heruntergefahren, der Aufrufer arbeitet alles selbst ab
+        }
+        run();
+
+        std::unique_lock lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->done == count; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+
     // 1) Einfachen Task enqueuen, bekommt eine future<void>
     template<typename F>
     std::future<void> schedule(F&& fn) {
@@ -75,12 +137,18 @@ private:
                 tasks.pop();
             }
 
-            // 1. Job ausfhren
-            task->fn();
-            // 2. Callback (falls vorhanden)
-            if (task->cb) task->cb();
-            // 3. Fertig melden
-            task->promise.set_value();
+            try {
+                // 1. Job ausfhren
+                task->fn();
+                // 2. Callback (falls vorhanden)
+                if (task->cb) task->cb();
+                // 3. Fertig melden
+                task->promise.set_value();
+            }
+            catch (...) {
+                // Exception landet in der future statt den Worker zu beenden
+                task->promise.set_exception(std::current_exception());
+            }
         }
     }
 
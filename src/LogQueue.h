@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <string_view>
+
+namespace engine {
+	// Fixed size log entry, the message is truncated to k_maxText bytes. File and function
+	// come from std::source_location and point to static storage.
+	struct LogRecord {
+		static constexpr uint32_t k_maxText = 400;
+
+		int64_t time;
+		const char* file;
+		const char* function;
+		uint32_t line;
+		uint16_t length;
+		uint8_t level;
+		char text[k_maxText];
+	};
+
+	// Bounded multi producer / single consumer queue (Vyukov's sequence ring). push never
+	// blocks or allocates, a full queue drops the record instead of stalling the caller.
+	class LogQueue {
+	public:
+		static constexpr uint32_t k_capacity = 1u << 10;
+
+		LogQueue() : m_cells(std::make_unique<Cell[]>(k_capacity)) {
+			for (uint32_t i = 0; i < k_capacity; ++i)
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		bool push(int64_t time, uint8_t level, std::string_view message, const char* file, const char* function, uint32_t line) {
+			uint32_t pos = m_enqueue.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;) {
+				cell = &m_cells[pos & (k_capacity - 1)];
+				const uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+				const int32_t diff = static_cast<int32_t>(sequence - pos);
+				if (diff == 0) {
+					if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0) {
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else {
+					pos = m_enqueue.load(std::memory_order_relaxed);
+				}
+			}
+
+			LogRecord& record = cell->record;
+			record.time = time;
+			record.file = file;
+			record.function = function;
+			record.line = line;
+			record.level = level;
+			record.length = static_cast<uint16_t>(std::min<size_t>(message.size(), LogRecord::k_maxText));
+			std::memcpy(record.text, message.data(), record.length);
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Only ever called from the consumer thread
+		bool pop(LogRecord& out) {
+			const uint32_t pos = m_dequeue.load(std::memory_order_relaxed);
+			Cell& cell = m_cells[pos & (k_capacity - 1)];
+			if (static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - (pos + 1)) < 0)
+				return false;
+
+			out = cell.record;
+			m_dequeue.store(pos + 1, std::memory_order_relaxed);
+			cell.sequence.store(pos + k_capacity, std::memory_order_release);
+			return true;
+		}
+
+		uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	private:
+		struct Cell {
+			std::atomic<uint32_t> sequence;
+			LogRecord record;
+		};
+
+		std::unique_ptr<Cell[]> m_cells;
+		alignas(64) std::atomic<uint32_t> m_enqueue{ 0 };
+		alignas(64) std::atomic<uint32_t> m_dequeue{ 0 };
+		std::atomic<uint64_t> m_dropped{ 0 };
+	};
+}
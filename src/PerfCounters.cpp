@@ -0,0 +1,117 @@
+#include "PerfCounters.h"
+
+#if defined(ENABLE_PERF_COUNTERS) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace engine {
+	const char* PerfCounters::name(Counter counter) {
+		switch (counter) {
+		case Cycles:       return "cycles";
+		case Instructions: return "instructions";
+		case CacheMisses:  return "cacheMisses";
+		case BranchMisses: return "branchMisses";
+		default:           return "";
+		}
+	}
+
+#if defined(ENABLE_PERF_COUNTERS) && defined(__linux__)
+	namespace {
+		constexpr uint64_t k_events[PerfCounters::Count] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+		};
+
+		// One group per thread so a single read() returns all counters at once
+		struct ThreadCounters {
+			int fds[PerfCounters::Count] = { -1, -1, -1, -1 };
+			uint64_t ids[PerfCounters::Count] = {};
+			int leader = -1;
+			bool opened = false;
+
+			~ThreadCounters() {
+				for (int fd : fds) {
+					if (fd != -1)
+						close(fd);
+				}
+			}
+
+			void open() {
+				opened = true;
+				for (int i = 0; i < PerfCounters::Count; ++i) {
+					perf_event_attr attr;
+					std::memset(&attr, 0, sizeof(attr));
+					attr.size = sizeof(attr);
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = k_events[i];
+					attr.disabled = leader == -1 ? 1 : 0;
+					attr.exclude_kernel = 1;
+					attr.exclude_hv = 1;
+					attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+					const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+					if (fd == -1)
+						continue;
+					ioctl(fd, PERF_EVENT_IOC_ID, &ids[i]);
+					fds[i] = fd;
+					if (leader == -1)
+						leader = fd;
+				}
+
+				if (leader != -1) {
+					ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+					ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+				}
+			}
+		};
+		thread_local ThreadCounters t_counters;
+	}
+
+	void PerfCounters::read(uint64_t (&values)[Count]) {
+		ThreadCounters& counters = t_counters;
+		if (!counters.opened)
+			counters.open();
+
+		for (uint64_t& value : values)
+			value = 0;
+		if (counters.leader == -1)
+			return;
+
+		struct {
+			uint64_t nr;
+			struct {
+				uint64_t value;
+				uint64_t id;
+			} values[Count];
+		} group;
+		if (::read(counters.leader, &group, sizeof(group)) <= 0)
+			return;
+
+		for (uint64_t i = 0; i < group.nr && i < Count; ++i) {
+			for (int c = 0; c < Count; ++c) {
+				if (counters.fds[c] != -1 && counters.ids[c] == group.values[i].id)
+					values[c] = group.values[i].value;
+			}
+		}
+	}
+
+	bool PerfCounters::available() {
+		ThreadCounters& counters = t_counters;
+		if (!counters.opened)
+			counters.open();
+		return counters.leader != -1;
+	}
+#else
+	void PerfCounters::read(uint64_t (&values)[Count]) {
+		for (uint64_t& value : values)
+			value = 0;
+	}
+
+	bool PerfCounters::available() {
+		return false;
+	}
+#endif
+}
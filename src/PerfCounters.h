@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+namespace engine {
+	// Hardware counters of the calling thread through perf_event_open. Only compiled in on
+	// Linux with ENABLE_PERF_COUNTERS, everywhere else read() leaves the values at zero.
+	class PerfCounters {
+	public:
+		enum Counter { Cycles, Instructions, CacheMisses, BranchMisses, Count };
+
+#if defined(ENABLE_PERF_COUNTERS) && defined(__linux__)
+		static constexpr bool k_enabled = true;
+#else
+		static constexpr bool k_enabled = false;
+#endif
+
+		// Opens the counter group of the thread on first use. Counters the CPU or the
+		// kernel refuses (VMs, perf_event_paranoid) stay zero.
+		static void read(uint64_t (&values)[Count]);
+		static bool available();
+
+		static const char* name(Counter counter);
+	};
+}
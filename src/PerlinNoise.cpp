@@ -1,18 +1,129 @@
 #include "PerlinNoise.h"
+#include "JobSystem.h"
+#include "CpuFeatures.h"
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <numeric>
 
+#if defined(ENGINE_SIMD_X86)
+#include <immintrin.h>
+#endif
 
 namespace engine {
+	namespace {
+#if defined(ENGINE_SIMD_X86)
+		// Lambdas would not inherit the AVX2 target, the helpers carry it themselves
+		ENGINE_TARGET_AVX2 inline __m256 fade8(__m256 t) {
+			__m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.f)), _mm256_set1_ps(15.f))), _mm256_set1_ps(10.f));
+			return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+		}
+		ENGINE_TARGET_AVX2 inline __m256 lerp8(__m256 a, __m256 b, __m256 t) { return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a))); }
+		ENGINE_TARGET_AVX2 inline __m256 grad8(const float* gradientX, const float* gradientY, __m256i hash, __m256 dx, __m256 dy) {
+			__m256 gx = _mm256_i32gather_ps(gradientX, hash, 4);
+			__m256 gy = _mm256_i32gather_ps(gradientY, hash, 4);
+			return _mm256_add_ps(_mm256_mul_ps(gx, dx), _mm256_mul_ps(gy, dy));
+		}
 
-	std::vector<int> perm;
-	std::vector<glm::vec2> gradients;
+		// Both return how many samples they handled, the rest goes through Perlin2D
+		ENGINE_TARGET_AVX2 size_t perlinAvx2(const int32_t* perm, const float* gradientX, const float* gradientY,
+			const float* xs, const float* ys, float* out, size_t count) {
+			size_t i = 0;
+			const __m256i mask = _mm256_set1_epi32(255);
+			const __m256i one = _mm256_set1_epi32(1);
+			const __m256 onef = _mm256_set1_ps(1.f);
+			const __m256 half = _mm256_set1_ps(0.5f);
 
-	PerlinNoise::PerlinNoise(unsigned int seed) {
-		perm.resize(512);
-		gradients.resize(256);
+			for (; i + 8 <= count; i += 8) {
+				__m256 x = _mm256_loadu_ps(xs + i);
+				__m256 y = _mm256_loadu_ps(ys + i);
+				__m256 fx = _mm256_floor_ps(x);
+				__m256 fy = _mm256_floor_ps(y);
+				__m256i X = _mm256_and_si256(_mm256_cvtps_epi32(fx), mask);
+				__m256i Y = _mm256_and_si256(_mm256_cvtps_epi32(fy), mask);
+				x = _mm256_sub_ps(x, fx);
+				y = _mm256_sub_ps(y, fy);
+				__m256 u = fade8(x);
+				__m256 v = fade8(y);
+
+				const int* table = perm;
+				__m256i pX = _mm256_i32gather_epi32(table, X, 4);
+				__m256i pX1 = _mm256_i32gather_epi32(table, _mm256_add_epi32(X, one), 4);
+				__m256i aa = _mm256_add_epi32(pX, Y);
+				__m256i ba = _mm256_add_epi32(pX1, Y);
+
+				__m256 xm1 = _mm256_sub_ps(x, onef);
+				__m256 ym1 = _mm256_sub_ps(y, onef);
+				__m256 gradAA = grad8(gradientX, gradientY, _mm256_i32gather_epi32(table, aa, 4), x, y);
+				__m256 gradBA = grad8(gradientX, gradientY, _mm256_i32gather_epi32(table, ba, 4), xm1, y);
+				__m256 gradAB = grad8(gradientX, gradientY, _mm256_i32gather_epi32(table, _mm256_add_epi32(aa, one), 4), x, ym1);
+				__m256 gradBB = grad8(gradientX, gradientY, _mm256_i32gather_epi32(table, _mm256_add_epi32(ba, one), 4), xm1, ym1);
+
+				__m256 result = lerp8(lerp8(gradAA, gradBA, u), lerp8(gradAB, gradBB, u), v);
+				_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(result, half), half));
+			}
+			return i;
+		}
+
+		size_t perlinSse2(const int32_t* perm, const float* gradientX, const float* gradientY,
+			const float* xs, const float* ys, float* out, size_t count) {
+			size_t i = 0;
+			// SSE2 has no gathers, the table lookups go through the stack, the arithmetic stays vectorized
+			const __m128 onef = _mm_set1_ps(1.f);
+			const __m128 half = _mm_set1_ps(0.5f);
+
+			auto floor4 = [onef](__m128 v) {
+				__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+				return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), onef));
+			};
+			auto fade = [](__m128 t) {
+				__m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.f)), _mm_set1_ps(15.f))), _mm_set1_ps(10.f));
+				return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+			};
+			auto lerp = [](__m128 a, __m128 b, __m128 t) { return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a))); };
+
+			for (; i + 4 <= count; i += 4) {
+				__m128 x = _mm_loadu_ps(xs + i);
+				__m128 y = _mm_loadu_ps(ys + i);
+				__m128 fx = floor4(x);
+				__m128 fy = floor4(y);
+
+				alignas(16) int32_t X[4], Y[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(X), _mm_cvttps_epi32(fx));
+				_mm_store_si128(reinterpret_cast<__m128i*>(Y), _mm_cvttps_epi32(fy));
+
+				alignas(16) float gx[4][4], gy[4][4]; // [corner][lane], corners AA, BA, AB, BB
+				for (int lane = 0; lane < 4; ++lane) {
+					const int xi = X[lane] & 255;
+					const int yi = Y[lane] & 255;
+					const int aa = perm[xi] + yi;
+					const int ba = perm[xi + 1] + yi;
+					const int hashes[4] = { perm[aa], perm[ba], perm[aa + 1], perm[ba + 1] };
+					for (int corner = 0; corner < 4; ++corner) {
+						gx[corner][lane] = gradientX[hashes[corner]];
+						gy[corner][lane] = gradientY[hashes[corner]];
+					}
+				}
+
+				x = _mm_sub_ps(x, fx);
+				y = _mm_sub_ps(y, fy);
+				__m128 u = fade(x);
+				__m128 v = fade(y);
+				__m128 xm1 = _mm_sub_ps(x, onef);
+				__m128 ym1 = _mm_sub_ps(y, onef);
 
+				auto grad = [&](int corner, __m128 dx, __m128 dy) {
+					return _mm_add_ps(_mm_mul_ps(_mm_load_ps(gx[corner]), dx), _mm_mul_ps(_mm_load_ps(gy[corner]), dy));
+				};
+				__m128 result = lerp(lerp(grad(0, x, y), grad(1, xm1, y), u), lerp(grad(2, x, ym1), grad(3, xm1, ym1), u), v);
+				_mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(result, half), half));
+			}
+			return i;
+		}
+#endif
+	}
+
+	PerlinNoise::PerlinNoise(unsigned int seed) {
 		std::vector<int> p(256);
 		std::iota(p.begin(), p.end(), 0);
 
@@ -27,7 +138,8 @@ namespace engine {
 		std::uniform_real_distribution<float> distribution(0.0f, 2.0f * glm::pi<float>());
 		for (int i = 0; i < 256; i++) {
 			float angle = distribution(engine); // use the seeded engine here
-			gradients[i] = glm::vec2(cos(angle), sin(angle));
+			gradientX[i] = cos(angle);
+			gradientY[i] = sin(angle);
 		}
 	}
 
@@ -45,12 +157,12 @@ namespace engine {
 
 	float PerlinNoise::Lerp(float a, float b, float t) { return a + t * (b - a); }
 
-	float PerlinNoise::Grad(int hash, float x, float y) {
+	float PerlinNoise::Grad(int hash, float x, float y) const {
 		int index = hash & 255;
-		return gradients[index].x * x + gradients[index].y * y;
+		return gradientX[index] * x + gradientY[index] * y;
 	}
 
-	float PerlinNoise::Perlin2D(float x, float y) {
+	float PerlinNoise::Perlin2D(float x, float y) const {
 		int X = (int)floor(x) & 255;
 		int Y = (int)floor(y) & 255;
 
@@ -60,7 +172,6 @@ namespace engine {
 		float u = Fade(x);
 		float v = Fade(y);
 
-		assert(!perm.empty() && "Permutation table is empty!");
 		assert(X >= 0 && X < 256 && "X is out of range!");
 		assert(Y >= 0 && Y < 256 && "Y is out of range!");
 
@@ -80,4 +191,153 @@ namespace engine {
 
 		return result * 0.5f + 0.5f;
 	}
-}
\ No newline at end of file
+
+	void PerlinNoise::Perlin2DBatch(const float* xs, const float* ys, float* out, size_t count) const {
+		size_t i = 0;
+
+#if defined(ENGINE_SIMD_X86)
+		switch (CpuFeatures::simd()) {
+		case CpuFeatures::Simd::Avx2: i = perlinAvx2(perm.data(), gradientX.data(), gradientY.data(), xs, ys, out, count); break;
+		case CpuFeatures::Simd::Sse2: i = perlinSse2(perm.data(), gradientX.data(), gradientY.data(), xs, ys, out, count); break;
+		default: break;
+		}
+#endif
+
+		for (; i < count; ++i)
+			out[i] = Perlin2D(xs[i], ys[i]);
+	}
+
+	void PerlinNoise::Octaves(bool ridged, const float* xs, const float* ys, float* out, size_t count, const FractalSettings& settings) const {
+		thread_local std::vector<float> scaledX, scaledY, octave;
+		scaledX.resize(count);
+		scaledY.resize(count);
+		octave.resize(count);
+		std::fill(out, out + count, 0.f);
+
+		float amplitude = 1.f;
+		float frequency = settings.frequency;
+		float norm = 0.f;
+		for (int o = 0; o < settings.octaves; ++o) {
+			for (size_t i = 0; i < count; ++i) {
+				scaledX[i] = xs[i] * frequency;
+				scaledY[i] = ys[i] * frequency;
+			}
+			Perlin2DBatch(scaledX.data(), scaledY.data(), octave.data(), count);
+
+			if (ridged) {
+				for (size_t i = 0; i < count; ++i) {
+					float r = 1.f - std::abs(octave[i] * 2.f - 1.f);
+					out[i] += amplitude * r * r;
+				}
+			}
+			else {
+				for (size_t i = 0; i < count; ++i)
+					out[i] += amplitude * (octave[i] * 2.f - 1.f);
+			}
+
+			norm += amplitude;
+			amplitude *= settings.gain;
+			frequency *= settings.lacunarity;
+		}
+
+		if (norm <= 0.f) return;
+		// Back to [0, 1] like Perlin2D
+		const float scale = ridged ? 1.f / norm : 0.5f / norm;
+		const float offset = ridged ? 0.f : 0.5f;
+		for (size_t i = 0; i < count; ++i)
+			out[i] = out[i] * scale + offset;
+	}
+
+	float PerlinNoise::Fbm(float x, float y, const FractalSettings& settings) const {
+		float sum = 0.f, norm = 0.f;
+		float amplitude = 1.f;
+		float frequency = settings.frequency;
+		for (int o = 0; o < settings.octaves; ++o) {
+			sum += amplitude * (Perlin2D(x * frequency, y * frequency) * 2.f - 1.f);
+			norm += amplitude;
+			amplitude *= settings.gain;
+			frequency *= settings.lacunarity;
+		}
+		return norm > 0.f ? sum / norm * 0.5f + 0.5f : 0.5f;
+	}
+
+	void PerlinNoise::FillRow(Fractal fractal, float* out, int count, float x0, float y, float step,
+		const FractalSettings& settings, const WarpSettings& warp) const
+	{
+		thread_local std::vector<float> xs, ys, warpX, warpY, shiftedY;
+		xs.resize(count);
+		ys.resize(count);
+		for (int i = 0; i < count; ++i) {
+			xs[i] = x0 + static_cast<float>(i) * step;
+			ys[i] = y;
+		}
+
+		switch (fractal) {
+		case Fractal::None:
+			Perlin2DBatch(xs.data(), ys.data(), out, count);
+			break;
+		case Fractal::Fbm:
+			Octaves(false, xs.data(), ys.data(), out, count, settings);
+			break;
+		case Fractal::Ridged:
+			Octaves(true, xs.data(), ys.data(), out, count, settings);
+			break;
+		case Fractal::Warped: {
+			warpX.resize(count);
+			warpY.resize(count);
+			Octaves(false, xs.data(), ys.data(), warpX.data(), count, warp.fractal);
+
+			// Second warp field from a shifted domain so the offsets in x and y are uncorrelated,
+			// out serves as scratch for the shifted x until the final pass
+			shiftedY.resize(count);
+			float* shiftedX = out;
+			for (int i = 0; i < count; ++i) {
+				shiftedX[i] = xs[i] + 5.2f;
+				shiftedY[i] = ys[i] + 1.3f;
+			}
+			Octaves(false, shiftedX, shiftedY.data(), warpY.data(), count, warp.fractal);
+
+			for (int i = 0; i < count; ++i) {
+				xs[i] += warp.amplitude * (warpX[i] * 2.f - 1.f);
+				ys[i] += warp.amplitude * (warpY[i] * 2.f - 1.f);
+			}
+			Octaves(false, xs.data(), ys.data(), out, count, settings);
+			break;
+		}
+		}
+	}
+
+	void PerlinNoise::FillTiled(Fractal fractal, float* out, int width, int height, float x0, float y0, float step,
+		const FractalSettings& settings, const WarpSettings& warp) const
+	{
+		if (width <= 0 || height <= 0) return;
+
+		constexpr int k_tileRows = 16;
+		const size_t tiles = static_cast<size_t>((height + k_tileRows - 1) / k_tileRows);
+		ThreadPool::global().parallelFor(tiles, [&](size_t tile) {
+			const int firstRow = static_cast<int>(tile) * k_tileRows;
+			const int lastRow = std::min(height, firstRow + k_tileRows);
+			for (int row = firstRow; row < lastRow; ++row) {
+				FillRow(fractal, out + static_cast<size_t>(row) * width, width, x0, y0 + static_cast<float>(row) * step, step, settings, warp);
+			}
+		});
+	}
+
+	void PerlinNoise::FillGrid(float* out, int width, int height, float x0, float y0, float step) const {
+		FillTiled(Fractal::None, out, width, height, x0, y0, step, {}, {});
+	}
+
+	void PerlinNoise::FillFbm(float* out, int width, int height, float x0, float y0, float step, const FractalSettings& settings) const {
+		FillTiled(Fractal::Fbm, out, width, height, x0, y0, step, settings, {});
+	}
+
+	void PerlinNoise::FillRidged(float* out, int width, int height, float x0, float y0, float step, const FractalSettings& settings) const {
+		FillTiled(Fractal::Ridged, out, width, height, x0, y0, step, settings, {});
+	}
+
+	void PerlinNoise::FillWarped(float* out, int width, int height, float x0, float y0, float step,
+		const FractalSettings& settings, const WarpSettings& warp) const
+	{
+		FillTiled(Fractal::Warped, out, width, height, x0, y0, step, settings, warp);
+	}
+}
@@ -1,21 +1,66 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <random>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
 namespace engine {
+	// Octave settings shared by fBm, ridged noise and the domain warp
+	struct FractalSettings {
+		int octaves = 5;
+		float frequency = 1.f;
+		float lacunarity = 2.f;   // Frequency multiplier per octave
+		float gain = 0.5f;        // Amplitude multiplier per octave
+	};
+
+	struct WarpSettings {
+		float amplitude = 4.f;    // Offset in input units at full strength
+		FractalSettings fractal{ 3, 0.5f, 2.f, 0.5f };
+	};
+
 	class PerlinNoise {
 	public:
 		PerlinNoise(unsigned int seed = 1337);
 
-		float Perlin2D(float x, float y);
+		// Single sample in [0, 1]
+		float Perlin2D(float x, float y) const;
+
+		// Perlin2D for count arbitrary points, SIMD (AVX2 or SSE2, picked at runtime) with a scalar tail
+		void Perlin2DBatch(const float* xs, const float* ys, float* out, size_t count) const;
+
+		// Grid fills: out[row * width + column] samples (x0 + column * step, y0 + row * step).
+		// Rows are split into tiles that run on ThreadPool::global(), all results are in [0, 1].
+		void FillGrid(float* out, int width, int height, float x0, float y0, float step) const;
+		void FillFbm(float* out, int width, int height, float x0, float y0, float step, const FractalSettings& settings) const;
+		void FillRidged(float* out, int width, int height, float x0, float y0, float step, const FractalSettings& settings) const;
+		// fBm sampled at positions offset by two further fBm fields
+		void FillWarped(float* out, int width, int height, float x0, float y0, float step,
+			const FractalSettings& settings, const WarpSettings& warp) const;
+
+		float Fbm(float x, float y, const FractalSettings& settings) const;
 
 	private:
-		std::vector<int> perm;
-		float Fade(float t);
-		float Grad(int hash, float x, float y);
-		glm::vec2 RandomGradient(int ix, int iy);
-		float Lerp(float a, float b, float t);
+		enum class Fractal { None, Fbm, Ridged, Warped };
+
+		// One row of count samples starting at (x0, y) into out
+		void FillRow(Fractal fractal, float* out, int count, float x0, float y, float step,
+			const FractalSettings& settings, const WarpSettings& warp) const;
+		void FillTiled(Fractal fractal, float* out, int width, int height, float x0, float y0, float step,
+			const FractalSettings& settings, const WarpSettings& warp) const;
+		// Accumulates fBm or ridged octaves for count points into out
+		void Octaves(bool ridged, const float* xs, const float* ys, float* out, size_t count, const FractalSettings& settings) const;
+
+		// Duplicated so index + 1 never wraps, int32 so AVX2 can gather straight from it
+		std::array<int32_t, 512> perm;
+		std::array<float, 256> gradientX;
+		std::array<float, 256> gradientY;
+
+		static float Fade(float t);
+		float Grad(int hash, float x, float y) const;
+		static glm::vec2 RandomGradient(int ix, int iy);
+		static float Lerp(float a, float b, float t);
 	};
 }
@@ -1,18 +1,61 @@
 ﻿#include "Physics/PhysicsSystem.h"
 #include "Components/BoxCollider.h"
+#include "Core/Profiler.h"
 #include <iostream>
 
 namespace engine {
 	void PhysicsSystem::update() {
 		Box2DWorld& physicsWorld = Scene::physicsWorld();
-		physicsWorld.Step(Time::fixedDeltaTime());
-		physicsWorld.dispatcher().process(physicsWorld.worldID());
+		{
+			// Transforms moved by game code since the last step take their bodies along
+			PROFILE_ZONE("Physics::Teleport");
+			size_t teleported = 0;
+			for (auto& scene : SceneManager::loadedScenes) {
+				entt::registry& registry = scene->registry();
+				// Only the transforms recorded as teleported, not every body
+				scene->takeTeleportedTransforms(m_teleported);
+				teleported += m_teleported.size();
+				for (uint32_t id : m_teleported) {
+					const entt::entity entity = static_cast<entt::entity>(id);
+					if (!registry.valid(entity)) continue;
+					Transform2D* tf = registry.try_get<Transform2D>(entity);
+					// Recorded twice, or parked: those keep the flag and are recorded again when taken out of their pool
+					if (tf == nullptr || !(tf->m_flags & Transform2D::k_teleport) || registry.all_of<Inactive>(entity)) continue;
+					tf->m_flags &= ~Transform2D::k_teleport;
+					if (Rigidbody2D* rb = registry.try_get<Rigidbody2D>(entity))
+						b2Body_SetTransform(rb->m_bodyId, b2Vec2(tf->position().x, tf->position().y), tf->b2Rotation());
+				}
+			}
+			PROFILE_ZONE_ITEMS(teleported);
+		}
+		{
+			PROFILE_ZONE("Physics::Step");
+			physicsWorld.Step(Time::fixedDeltaTime());
+		}
+		{
+			PROFILE_ZONE("Physics::Contacts");
+			physicsWorld.dispatcher().process(physicsWorld.worldID());
+		}
+
+		// Only bodies that moved during the step are reported, sleeping ones cost nothing
+		PROFILE_ZONE("Physics::SyncTransforms");
+		const b2BodyEvents events = b2World_GetBodyEvents(physicsWorld.worldID());
+		PROFILE_ZONE_ITEMS(events.moveCount);
+		for (int i = 0; i < events.moveCount; ++i) {
+			const b2BodyMoveEvent& move = events.moveEvents[i];
+			const entt::entity entity = static_cast<entt::entity>(reinterpret_cast<uintptr_t>(move.userData));
+
+			// The world is shared, entity ids can repeat across scenes, the body id decides
+			for (auto& scene : SceneManager::loadedScenes) {
+				entt::registry& registry = scene->registry();
+				if (!registry.valid(entity)) continue;
+				auto* rb = registry.try_get<Rigidbody2D>(entity);
+				auto* tf = registry.try_get<Transform2D>(entity);
+				if (!rb || !tf || !B2_ID_EQUALS(rb->m_bodyId, move.bodyId)) continue;
 
-		for (auto& scene : SceneManager::loadedScenes)
-			for (auto [ent, rb, tf] : scene->registry().view<Rigidbody2D, Transform2D>().each()) {
-				glm::vec2 targetPos = rb.getPosition();
-				tf.position = targetPos;
-				tf.rotation = rb.getRotation();
+				tf->syncFromPhysics({ move.transform.p.x, move.transform.p.y }, move.transform.q);
+				break;
 			}
+		}
 	}
 }
\ No newline at end of file
@@ -12,5 +12,14 @@ namespace engine {
 	class PhysicsSystem {
 	public:
 		void update();
+
+		// Active rigidbodies with a transform, set up with the scene. Non-owning: an owning group
+		// swaps its components around and ~Rigidbody2D destroys the body of the copy it leaves.
+		static auto bodies(entt::registry& registry) {
+			return registry.group<>(entt::get<Rigidbody2D, Transform2D>, entt::exclude<Inactive>);
+		}
+
+	private:
+		std::vector<uint32_t> m_teleported;
 	};
 }
\ No newline at end of file
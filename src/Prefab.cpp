@@ -0,0 +1,45 @@
+#include "Prefab.h"
+#include "Core/Profiler.h"
+
+namespace engine {
+	entt::entity Prefab::instantiate(Scene& scene) {
+		std::vector<entt::entity> entities;
+		spawn(scene, 1, nullptr, entities);
+		return entities.front();
+	}
+
+	void Prefab::instantiate(Scene& scene, size_t count, std::vector<entt::entity>& out) {
+		spawn(scene, count, nullptr, out);
+	}
+
+	void Prefab::instantiate(Scene& scene, std::span<const Transform2D> transforms, std::vector<entt::entity>& out) {
+		spawn(scene, transforms.size(), transforms.data(), out);
+	}
+
+	void Prefab::spawn(Scene& scene, size_t count, const Transform2D* transforms, std::vector<entt::entity>& out) {
+		if (count == 0) return;
+		PROFILE_ZONE("Prefab::Instantiate");
+		PROFILE_ZONE_ITEMS(count);
+
+		entt::registry& registry = scene.registry();
+		const size_t offset = out.size();
+		out.resize(offset + count);
+		registry.create(out.begin() + offset, out.end());
+		const entt::entity* first = out.data() + offset;
+		const entt::entity* last = first + count;
+
+		const entt::id_type transformType = entt::type_hash<Transform2D>::value();
+		if (transforms != nullptr)
+			registry.insert<Transform2D>(first, last, transforms);
+		for (const auto& component : m_components) {
+			if (transforms != nullptr && component->type == transformType) continue;
+			component->insert(registry, first, last);
+		}
+
+		if (m_attachments.empty()) return;
+		for (const entt::entity* it = first; it != last; ++it) {
+			for (const auto& attach : m_attachments)
+				attach(scene, *it);
+		}
+	}
+}
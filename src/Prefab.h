@@ -0,0 +1,85 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "Core/Scene.h"
+#include "Components/Transform.h"
+
+namespace engine {
+	// Entity template that is built once and instantiated in bulk. Plain components are copied
+	// into all instances with one registry.insert per type, components that need the scene
+	// (rigidbodies, colliders) are created per instance right after, in the order they were
+	// attached. Attach a Rigidbody2D before its colliders so they share the body.
+	class Prefab {
+	public:
+		// Copied into every instance, a second call for the same type replaces the value
+		template<typename T>
+		Prefab& with(T component = {}) {
+			const entt::id_type id = entt::type_hash<T>::value();
+			for (auto& entry : m_components) {
+				if (entry->type == id) {
+					entry = std::make_unique<TypedComponent<T>>(id, std::move(component));
+					return *this;
+				}
+			}
+			m_components.push_back(std::make_unique<TypedComponent<T>>(id, std::move(component)));
+			return *this;
+		}
+
+		// Constructed with (entity, Scene&) for every instance, setup runs on the new component
+		template<typename T>
+		Prefab& attach(std::function<void(T&)> setup = {}) {
+			static_assert(std::is_constructible_v<T, entt::entity, Scene&>, "T must be constructible from (entt::entity, Scene&)");
+			m_attachments.push_back([setup = std::move(setup)](Scene& scene, entt::entity entity) {
+				T& component = scene.registry().emplace<T>(entity, entity, scene);
+				if (setup) setup(component);
+			});
+			return *this;
+		}
+
+		template<typename T>
+		bool has() const {
+			const entt::id_type id = entt::type_hash<T>::value();
+			return std::any_of(m_components.begin(), m_components.end(), [id](const auto& entry) { return entry->type == id; });
+		}
+
+		// Runs for every instance after all components exist
+		Prefab& onInstantiate(std::function<void(Scene&, entt::entity)> fn) {
+			m_attachments.push_back(std::move(fn));
+			return *this;
+		}
+
+		entt::entity instantiate(Scene& scene);
+		// Appends the new entities to out
+		void instantiate(Scene& scene, size_t count, std::vector<entt::entity>& out);
+		// One instance per transform, they take the place of the prefab's own Transform2D
+		void instantiate(Scene& scene, std::span<const Transform2D> transforms, std::vector<entt::entity>& out);
+
+	private:
+		struct Component {
+			explicit Component(entt::id_type type) : type(type) {}
+			virtual ~Component() = default;
+			virtual void insert(entt::registry& registry, const entt::entity* first, const entt::entity* last) const = 0;
+			const entt::id_type type;
+		};
+
+		template<typename T>
+		struct TypedComponent final : Component {
+			TypedComponent(entt::id_type type, T value) : Component(type), value(std::move(value)) {}
+			void insert(entt::registry& registry, const entt::entity* first, const entt::entity* last) const override {
+				if constexpr (std::is_empty_v<T>) registry.insert<T>(first, last);
+				else registry.insert<T>(first, last, value);
+			}
+			T value;
+		};
+
+		void spawn(Scene& scene, size_t count, const Transform2D* transforms, std::vector<entt::entity>& out);
+
+		std::vector<std::unique_ptr<Component>> m_components;
+		std::vector<std::function<void(Scene&, entt::entity)>> m_attachments;
+	};
+}
@@ -1,9 +1,128 @@
 #include "Profiler.h"
+#include "AllocationTracker.h"
+#include "PerfCounters.h"
 #include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
 #include "Utils/Time.h"
+#include "Utils/Debug.h"
 #include "Graphics/Gizmos.h"
+#include "JobSystem.h"
 
 namespace engine {
+	namespace {
+		constexpr int k_maxZoneDepth = 64;
+		const char* k_categoryNames[] = { "Rendering", "Physics", "Update", "Fixedupdate" };
+
+		// Per thread zone stack, only ever touched by its own thread. The path root is
+		// leaked on purpose, events still in the buffer point into it after the thread exits.
+		struct ThreadZoneState {
+			ZoneBuffer* buffer = nullptr;
+			ZonePath* root = new ZonePath();
+			ZonePath* stack[k_maxZoneDepth];
+			uint32_t items[k_maxZoneDepth];
+			uint16_t depth = 0;
+		};
+		thread_local ThreadZoneState t_zoneState;
+
+		// A zone has few distinct children, a linear scan over the pointers beats hashing
+		ZonePath* enterPath(ZonePath* parent, const char* name) {
+			for (const auto& child : parent->children) {
+				if (child->name == name)
+					return child.get();
+			}
+			auto& child = parent->children.emplace_back(std::make_unique<ZonePath>());
+			child->name = name;
+			child->parent = parent;
+			return child.get();
+		}
+
+		uint64_t ticksToUs(uint64_t ticks) {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::duration(ticks)).count());
+		}
+
+		void writeJsonString(std::ostream& out, const char* s) {
+			out.put('"');
+			for (; *s != '\0'; ++s) {
+				const char c = *s;
+				if (c == '"' || c == '\\') {
+					out.put('\\');
+					out.put(c);
+				}
+				else if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					out << escaped;
+				}
+				else {
+					out.put(c);
+				}
+			}
+			out.put('"');
+		}
+
+		void writeHistogramJson(std::ostream& out, const LatencyHistogram& histogram) {
+			char number[128];
+			std::snprintf(number, sizeof(number), "\"count\":%llu,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f,\"buckets\":[",
+				static_cast<unsigned long long>(histogram.count()), histogram.percentile(50.0) / 1000.0,
+				histogram.percentile(95.0) / 1000.0, histogram.percentile(99.0) / 1000.0, histogram.max() / 1000.0);
+			out << number;
+
+			// Only non empty buckets as [upper bound in ms, count]
+			bool first = true;
+			for (uint32_t i = 0; i < LatencyHistogram::k_bucketCount; ++i) {
+				if (histogram.bucketCount(i) == 0)
+					continue;
+				std::snprintf(number, sizeof(number), "%s[%.3f,%u]", first ? "" : ",", LatencyHistogram::bucketUpperBound(i) / 1000.0, histogram.bucketCount(i));
+				out << number;
+				first = false;
+			}
+			out << "]";
+		}
+	}
+
+	void LatencyHistogram::add(const LatencyHistogram& other) {
+		for (uint32_t i = 0; i < k_bucketCount; ++i)
+			m_counts[i] += other.m_counts[i];
+		m_total += other.m_total;
+		m_max = std::max(m_max, other.m_max);
+	}
+
+	void LatencyHistogram::reset() {
+		m_counts.fill(0);
+		m_total = 0;
+		m_max = 0;
+	}
+
+	uint64_t LatencyHistogram::percentile(double p) const {
+		if (m_total == 0)
+			return 0;
+
+		const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * m_total)));
+		uint64_t seen = 0;
+		for (uint32_t i = 0; i < k_bucketCount; ++i) {
+			seen += m_counts[i];
+			if (seen >= rank)
+				return std::min(bucketUpperBound(i), m_max);
+		}
+		return m_max;
+	}
+
+	LatencyHistogram Profiler::RollingHistogram::merged() const {
+		LatencyHistogram result;
+		for (const auto& window : windows)
+			result.add(window);
+		return result;
+	}
+
+	LatencySummary Profiler::RollingHistogram::summary() const {
+		const LatencyHistogram histogram = merged();
+		return LatencySummary{ histogram.count(), histogram.percentile(50.0) / 1000.0, histogram.percentile(95.0) / 1000.0,
+			histogram.percentile(99.0) / 1000.0, histogram.max() / 1000.0 };
+	}
+
 	Profiler& Profiler::Get() {
 		static Profiler instance;
 		return instance;
@@ -16,16 +135,46 @@ namespace engine {
 		m_TabEnabled["GPU"] = true;
 		m_TabEnabled["Memory"] = true;
 		m_TabEnabled["General"] = true;
+
+		// Id 0 is reserved for "no parent"
+		m_Names.emplace_back("");
 	}
 
-	Profiler::~Profiler() {}
+	Profiler::~Profiler() {
+		if (m_CaptureWrite.valid())
+			m_CaptureWrite.wait();
+	}
 
 	void Profiler::BeginFrame() {
 		// Called at frame start
+		m_FrameStart = Now();
 	}
 
 	void Profiler::EndFrame() {
 		std::lock_guard<std::mutex> lock(m_Mutex);
+		const uint64_t frameEnd = Now();
+		DrainZones();
+		m_FramesInWindow++;
+
+		if (m_LastFrameEnd != 0)
+			m_FrameTimes.record(ticksToUs(frameEnd - m_LastFrameEnd), m_HistogramWindow);
+		m_LastFrameEnd = frameEnd;
+		m_SessionFrames++;
+
+		uint64_t frameAllocations = 0;
+		if constexpr (AllocationTracker::k_enabled) {
+			const AllocationCounters totals = AllocationTracker::totals();
+			frameAllocations = totals.allocations - m_LastAllocations;
+			m_WindowAllocations += frameAllocations;
+			m_WindowAllocatedBytes += totals.bytes - m_LastAllocatedBytes;
+			m_WindowPeakAllocations = std::max(m_WindowPeakAllocations, frameAllocations);
+			m_LastAllocations = totals.allocations;
+			m_LastAllocatedBytes = totals.bytes;
+		}
+
+		if (m_CaptureFramesLeft > 0)
+			RecordCaptureFrame(frameEnd, frameAllocations);
+
 		auto now = std::chrono::high_resolution_clock::now();
 		double elapsed = std::chrono::duration<double>(now - m_SecondTimer).count();
 		if (elapsed >= 1.0) {
@@ -35,38 +184,249 @@ namespace engine {
 		}
 	}
 
-	void Profiler::RecordCPU(CPUCategory category, double durationMs) {
+	StatId Profiler::RegisterStat(const char* name, StatGroup group, StatUnit unit, StatKind kind) {
 		std::lock_guard<std::mutex> lock(m_Mutex);
-		std::string key;
-		switch (category) {
-		case CPUCategory::Rendering: key = "Rendering"; break;
-		case CPUCategory::Physics:   key = "Physics";   break;
-		case CPUCategory::Update:     key = "Update";     break;
-		case CPUCategory::Fixedupdate:     key = "Fixedupdate";     break;
+		auto it = m_StatLookup.find(name);
+		if (it != m_StatLookup.end()) {
+			const StatInfo& info = m_StatInfos[it->second];
+			if (info.group != group || info.unit != unit || info.kind != kind)
+				Debug::logWarning(std::string("Profiler stat ") + name + " registered again with a different group, unit or kind, keeping the first");
+			return StatId{ it->second };
 		}
-		auto& entry = m_CPUStatEntries[key];
-		entry.accumulated += durationMs;
-		entry.samples++;
+
+		const uint32_t index = m_StatCount.load(std::memory_order_relaxed);
+		if (index >= k_maxStats) {
+			Debug::logWarning(std::string("Profiler stat table full, dropping ") + name);
+			return StatId{ 0 };
+		}
+
+		m_StatInfos[index] = StatInfo{ name, group, unit, kind };
+		m_StatLookup.emplace(name, static_cast<uint16_t>(index));
+		// The UI only walks up to m_StatCount, publish the slot after it is filled
+		m_StatCount.store(index + 1, std::memory_order_release);
+		return StatId{ static_cast<uint16_t>(index) };
 	}
 
-	void Profiler::SetCPUStatistic(const std::string& name, const std::string& info) {
-		std::lock_guard<std::mutex> lock(m_Mutex);
-		m_CPUStats[name] = info;
+	ZoneBuffer& Profiler::ThreadBuffer() {
+		// Only hit once per thread, the pointer is cached in t_zoneState afterwards
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		const uint32_t index = static_cast<uint32_t>(m_ZoneBuffers.size());
+		m_ZoneBuffers.push_back(std::make_unique<ZoneBuffer>(index, std::this_thread::get_id()));
+		return *m_ZoneBuffers.back();
+	}
+
+	void Profiler::SetThreadName(const std::string& name) {
+		ThreadZoneState& state = t_zoneState;
+		if (state.buffer == nullptr)
+			state.buffer = &ThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		m_ThreadNames[state.buffer->threadIndex()] = name;
+	}
+
+	void Profiler::AddZoneItems(uint32_t count) {
+		ThreadZoneState& state = t_zoneState;
+		if (state.depth > 0 && state.depth <= k_maxZoneDepth)
+			state.items[state.depth - 1] += count;
 	}
 
-	void Profiler::SetGPUStatistic(const std::string& name, const std::string& info) {
+	const char* Profiler::InternString(const std::string& str) {
 		std::lock_guard<std::mutex> lock(m_Mutex);
-		m_GPUStats[name] = info;
+		return m_InternedStrings.insert(str).first->c_str();
 	}
 
-	void Profiler::SetMemoryStatistic(const std::string& name, const std::string& info) {
+	void Profiler::BeginCapture(uint32_t frames, const std::string& path) {
 		std::lock_guard<std::mutex> lock(m_Mutex);
-		m_MemoryStats[name] = info;
+		if (frames == 0)
+			return;
+		if (m_CaptureWrite.valid() && m_CaptureWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			Debug::logWarning("Capture to " + path + " ignored, the last trace is still being written");
+			return;
+		}
+
+		m_CaptureZones.clear();
+		m_CaptureCounters.clear();
+		m_CaptureZones.reserve(frames * 64);
+		m_CaptureCounters.reserve(frames * (2 + m_StatCount.load(std::memory_order_acquire)));
+		m_CapturePath = path;
+		m_CaptureFramesLeft = frames;
+		m_CaptureStart = Now();
 	}
 
-	void Profiler::SetGeneralStatistic(const std::string& name, const std::string& info) {
+	bool Profiler::IsCapturing() {
 		std::lock_guard<std::mutex> lock(m_Mutex);
-		m_GeneralStats[name] = info;
+		return m_CaptureFramesLeft > 0
+			|| (m_CaptureWrite.valid() && m_CaptureWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+	}
+
+	void Profiler::RecordCaptureFrame(uint64_t frameEnd, uint64_t frameAllocations) {
+		ThreadZoneState& state = t_zoneState;
+		if (state.buffer == nullptr)
+			state.buffer = &ThreadBuffer();
+
+		// The frame itself is written as a zone on the thread that ends it
+		const uint64_t frameStart = std::max(m_FrameStart, m_CaptureStart);
+		const uint32_t mainThread = state.buffer->threadIndex();
+		m_CaptureZones.push_back({ ZoneEvent{ "Frame", nullptr, frameStart, frameEnd, 0, 0, 0, k_noCategory, 0 }, mainThread });
+		m_CaptureCounters.push_back({ "Frame time (ms)", mainThread, frameEnd, TicksToMs(frameEnd - m_FrameStart) });
+		if constexpr (AllocationTracker::k_enabled)
+			m_CaptureCounters.push_back({ "Allocations", mainThread, frameEnd, static_cast<double>(frameAllocations) });
+
+		// Stat names are never reassigned, so the pointers stay valid for the writer
+		const uint32_t statCount = m_StatCount.load(std::memory_order_acquire);
+		for (uint32_t i = 1; i < statCount; ++i)
+			m_CaptureCounters.push_back({ m_StatInfos[i].name.c_str(), mainThread, frameEnd, m_StatValues[i].load(std::memory_order_relaxed) });
+
+		if (--m_CaptureFramesLeft == 0)
+			FinishCapture();
+	}
+
+	void Profiler::FinishCapture() {
+		auto capture = std::make_shared<CaptureData>();
+		capture->path = m_CapturePath;
+		capture->start = m_CaptureStart;
+		capture->zones = std::move(m_CaptureZones);
+		capture->counters = std::move(m_CaptureCounters);
+		{
+			std::lock_guard<std::mutex> lock(m_BufferMutex);
+			capture->threadNames = m_ThreadNames;
+			for (const auto& buffer : m_ZoneBuffers)
+				capture->threadNames.try_emplace(buffer->threadIndex(), "Thread " + std::to_string(buffer->threadIndex()));
+		}
+		m_CaptureZones = {};
+		m_CaptureCounters = {};
+
+		try {
+			m_CaptureWrite = ThreadPool::global().schedule([capture] { WriteCapture(*capture); });
+		}
+		catch (const std::runtime_error&) {
+			// Pool already shut down
+			WriteCapture(*capture);
+		}
+	}
+
+	void Profiler::WriteCapture(const CaptureData& capture) {
+		std::ofstream out(capture.path, std::ios::trunc);
+		if (!out.is_open()) {
+			Debug::logError("Could not open trace file: " + capture.path);
+		}
+		else {
+			// Chrome trace timestamps are microseconds
+			auto toUs = [&capture](uint64_t ticks) { return TicksToMs(ticks - capture.start) * 1000.0; };
+			char number[64];
+			bool first = true;
+			auto separator = [&]() {
+				if (!first)
+					out << ",\n";
+				first = false;
+			};
+
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+			for (const auto& [index, name] : capture.threadNames) {
+				separator();
+				out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << index << ",\"args\":{\"name\":";
+				writeJsonString(out, name.c_str());
+				out << "}}";
+			}
+
+			for (const auto& zone : capture.zones) {
+				separator();
+				out << "{\"name\":";
+				writeJsonString(out, zone.event.name);
+				if (zone.event.category != k_noCategory) {
+					out << ",\"cat\":";
+					writeJsonString(out, k_categoryNames[zone.event.category]);
+				}
+				std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f", toUs(zone.event.start), TicksToMs(zone.event.end - zone.event.start) * 1000.0);
+				out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.threadIndex << number;
+				if (zone.event.allocations > 0)
+					out << ",\"args\":{\"allocations\":" << zone.event.allocations << ",\"bytes\":" << zone.event.allocatedBytes << "}";
+				out << "}";
+			}
+
+			for (const auto& counter : capture.counters) {
+				separator();
+				out << "{\"name\":";
+				writeJsonString(out, counter.name);
+				std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"args\":{\"value\":%.4f}}", toUs(counter.time), counter.value);
+				out << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << counter.threadIndex << number;
+			}
+
+			out << "\n]}\n";
+			Debug::log("Profiler trace written to " + capture.path);
+		}
+	}
+
+	uint32_t Profiler::InternName(const char* name) {
+		auto it = m_NameIds.find(name);
+		if (it != m_NameIds.end())
+			return it->second;
+
+		// Equal literals from different translation units may have different addresses
+		auto [lookup, inserted] = m_NameLookup.try_emplace(name, static_cast<uint32_t>(m_Names.size()));
+		if (inserted)
+			m_Names.emplace_back(name);
+
+		m_NameIds.emplace(name, lookup->second);
+		return lookup->second;
+	}
+
+	uint32_t Profiler::ResolveZone(ZonePath* path) {
+		// Cached on the node, only the first event of a path walks up and hashes
+		if (path->zoneId != 0)
+			return path->zoneId;
+
+		const bool topLevel = path->parent->name == nullptr;
+		const uint32_t parentZone = topLevel ? k_rootId : ResolveZone(path->parent);
+		const uint32_t nameId = InternName(path->name);
+		const uint64_t key = (static_cast<uint64_t>(parentZone) << 32) | nameId;
+
+		// Paths of different threads (or different name pointers) with the same names share a zone
+		auto [it, inserted] = m_ZoneIds.try_emplace(key, static_cast<uint32_t>(m_ZoneIds.size() + 1));
+		if (inserted) {
+			ZoneStats& zone = m_Zones[it->second];
+			zone.nameId = nameId;
+			zone.parentId = topLevel ? k_rootId : m_Zones[parentZone].nameId;
+			zone.parentZone = parentZone;
+		}
+		path->zoneId = it->second;
+		return path->zoneId;
+	}
+
+	void Profiler::DrainZones() {
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		for (auto& buffer : m_ZoneBuffers) {
+			buffer->drain([this, &buffer](const ZoneEvent& e) {
+				const double ms = TicksToMs(e.end - e.start);
+				ZoneStats& zone = m_Zones[ResolveZone(e.path)];
+				zone.accumulatedMs += ms;
+				zone.calls++;
+				zone.histogram.record(ticksToUs(e.end - e.start), m_HistogramWindow);
+				zone.allocations += e.allocations;
+				zone.allocatedBytes += e.allocatedBytes;
+				zone.items += e.items;
+#ifdef ENABLE_PERF_COUNTERS
+				for (int c = 0; c < PerfCounters::Count; ++c)
+					zone.perf[c] += e.perf[c];
+				// Nested zones are already part of their top level zone
+				if (e.depth == 0) {
+					ThreadPerfStats& thread = m_ThreadPerf[buffer->threadIndex()];
+					for (int c = 0; c < PerfCounters::Count; ++c)
+						thread.window[c] += e.perf[c];
+				}
+#endif
+
+				if (m_CaptureFramesLeft > 0 && e.end >= m_CaptureStart)
+					m_CaptureZones.push_back({ e, buffer->threadIndex() });
+
+				if (e.category != k_noCategory) {
+					auto& entry = m_CPUStatEntries[k_categoryNames[e.category]];
+					entry.accumulated += ms;
+					entry.samples++;
+				}
+				});
+		}
 	}
 
 	void Profiler::ToggleTab(const std::string& tabName, bool enabled) {
@@ -85,6 +445,149 @@ namespace engine {
 				e.lastValue = 0.0;
 			}
 		}
+
+		for (auto& [key, zone] : m_Zones) {
+			zone.avgFrameMs = m_FramesInWindow > 0 ? zone.accumulatedMs / m_FramesInWindow : 0.0;
+			zone.avgCallsPerFrame = m_FramesInWindow > 0 ? static_cast<double>(zone.calls) / m_FramesInWindow : 0.0;
+			zone.recent = zone.histogram.summary();
+			zone.avgAllocsPerFrame = m_FramesInWindow > 0 ? static_cast<double>(zone.allocations) / m_FramesInWindow : 0.0;
+			zone.avgAllocBytesPerFrame = m_FramesInWindow > 0 ? static_cast<double>(zone.allocatedBytes) / m_FramesInWindow : 0.0;
+			zone.avgItemsPerFrame = m_FramesInWindow > 0 ? static_cast<double>(zone.items) / m_FramesInWindow : 0.0;
+
+			const double units = static_cast<double>(zone.items > 0 ? zone.items : zone.calls);
+			zone.ipc = zone.perf[PerfCounters::Cycles] > 0 ? static_cast<double>(zone.perf[PerfCounters::Instructions]) / zone.perf[PerfCounters::Cycles] : 0.0;
+			zone.missesPerUnit[0] = units > 0.0 ? zone.perf[PerfCounters::CacheMisses] / units : 0.0;
+			zone.missesPerUnit[1] = units > 0.0 ? zone.perf[PerfCounters::BranchMisses] / units : 0.0;
+		}
+
+		for (auto& [index, thread] : m_ThreadPerf) {
+			for (int c = 0; c < PerfCounters::Count; ++c)
+				thread.perSecond[c] = static_cast<double>(thread.window[c]);
+			thread.ipc = thread.window[PerfCounters::Cycles] > 0 ? static_cast<double>(thread.window[PerfCounters::Instructions]) / thread.window[PerfCounters::Cycles] : 0.0;
+		}
+
+		const uint32_t statCount = m_StatCount.load(std::memory_order_acquire);
+		for (uint32_t i = 1; i < statCount; ++i) {
+			StatInfo& info = m_StatInfos[i];
+			if (info.kind != StatKind::Counter)
+				continue;
+			const double value = m_StatValues[i].load(std::memory_order_relaxed);
+			info.rate = value - info.lastCounterValue;
+			info.lastCounterValue = value;
+		}
+
+		m_AvgFrameAllocations = m_FramesInWindow > 0 ? static_cast<double>(m_WindowAllocations) / m_FramesInWindow : 0.0;
+		m_AvgFrameAllocatedBytes = m_FramesInWindow > 0 ? static_cast<double>(m_WindowAllocatedBytes) / m_FramesInWindow : 0.0;
+		m_PeakFrameAllocations = m_WindowPeakAllocations;
+
+		// Bars for the UI, trimmed to the range that actually has samples
+		const LatencyHistogram frameTimes = m_FrameTimes.merged();
+		m_FrameTimeSummary = m_FrameTimes.summary();
+		m_FrameTimePlot.clear();
+		if (frameTimes.count() > 0) {
+			uint32_t first = 0;
+			uint32_t last = LatencyHistogram::k_bucketCount - 1;
+			while (frameTimes.bucketCount(first) == 0) first++;
+			while (frameTimes.bucketCount(last) == 0) last--;
+			for (uint32_t i = first; i <= last; ++i)
+				m_FrameTimePlot.push_back(static_cast<float>(frameTimes.bucketCount(i)));
+			m_FrameTimePlotFirst = first;
+		}
+	}
+
+	void Profiler::RotateHistogramWindow() {
+		m_HistogramWindow = (m_HistogramWindow + 1) % k_histogramWindows;
+
+		m_FrameTimes.total.add(m_FrameTimes.windows[m_HistogramWindow]);
+		m_FrameTimes.windows[m_HistogramWindow].reset();
+		for (auto& [key, zone] : m_Zones) {
+			zone.histogram.total.add(zone.histogram.windows[m_HistogramWindow]);
+			zone.histogram.windows[m_HistogramWindow].reset();
+		}
+	}
+
+	LatencySummary Profiler::GetFrameTimeSummary() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_FrameTimes.summary();
+	}
+
+	LatencySummary Profiler::GetZoneSummary(const std::string& name) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto id = m_NameLookup.find(name);
+		if (id == m_NameLookup.end())
+			return {};
+
+		LatencyHistogram histogram;
+		for (const auto& [key, zone] : m_Zones) {
+			if (zone.nameId == id->second)
+				histogram.add(zone.histogram.merged());
+		}
+		return LatencySummary{ histogram.count(), histogram.percentile(50.0) / 1000.0, histogram.percentile(95.0) / 1000.0,
+			histogram.percentile(99.0) / 1000.0, histogram.max() / 1000.0 };
+	}
+
+	void Profiler::DumpHistograms(const std::string& path) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		DrainZones();
+
+		std::ofstream out(path, std::ios::trunc);
+		if (!out.is_open()) {
+			Debug::logError("Could not open histogram file: " + path);
+			return;
+		}
+
+		// The session total lags behind by the windows that were not rotated out yet
+		auto sessionTotal = [](const RollingHistogram& rolling) {
+			LatencyHistogram histogram = rolling.total;
+			histogram.add(rolling.merged());
+			return histogram;
+		};
+
+		out << "{\"unit\":\"ms\",\"frameTime\":{";
+		writeHistogramJson(out, sessionTotal(m_FrameTimes));
+		out << "},\n";
+
+		if constexpr (AllocationTracker::k_enabled) {
+			const AllocationCounters totals = AllocationTracker::totals();
+			char number[160];
+			std::snprintf(number, sizeof(number), "\"allocations\":{\"count\":%llu,\"frees\":%llu,\"bytes\":%llu,\"perFrame\":%.2f},\n",
+				static_cast<unsigned long long>(totals.allocations), static_cast<unsigned long long>(totals.frees), static_cast<unsigned long long>(totals.bytes),
+				m_SessionFrames > 0 ? static_cast<double>(totals.allocations) / m_SessionFrames : 0.0);
+			out << number;
+		}
+
+		out << "\"stats\":{";
+		const uint32_t statCount = m_StatCount.load(std::memory_order_acquire);
+		for (uint32_t i = 1; i < statCount; ++i) {
+			out << (i > 1 ? "," : "");
+			writeJsonString(out, m_StatInfos[i].name.c_str());
+			char number[32];
+			std::snprintf(number, sizeof(number), ":%.6g", m_StatValues[i].load(std::memory_order_relaxed));
+			out << number;
+		}
+		out << "},\n";
+
+		out << "\"zones\":[";
+
+		bool first = true;
+		for (const auto& [key, zone] : m_Zones) {
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			writeJsonString(out, m_Names[zone.nameId].c_str());
+			out << ",\"parent\":";
+			writeJsonString(out, m_Names[zone.parentId].c_str());
+			out << ",\"allocations\":" << zone.totalAllocations + zone.allocations << ",\"allocatedBytes\":" << zone.totalAllocatedBytes + zone.allocatedBytes;
+			out << ",\"items\":" << zone.totalItems + zone.items << ",";
+			if constexpr (PerfCounters::k_enabled) {
+				for (int c = 0; c < PerfCounters::Count; ++c)
+					out << "\"" << PerfCounters::name(static_cast<PerfCounters::Counter>(c)) << "\":" << zone.totalPerf[c] + zone.perf[c] << ",";
+			}
+			writeHistogramJson(out, sessionTotal(zone.histogram));
+			out << "}";
+			first = false;
+		}
+		out << "\n]}\n";
+
+		Debug::log("Profiler histograms written to " + path);
 	}
 
 	void Profiler::ResetFrameData() {
@@ -93,6 +596,157 @@ namespace engine {
 			kv.second.accumulated = 0.0;
 			kv.second.samples = 0;
 		}
+		for (auto& [key, zone] : m_Zones) {
+			zone.accumulatedMs = 0.0;
+			zone.calls = 0;
+			zone.totalAllocations += zone.allocations;
+			zone.totalAllocatedBytes += zone.allocatedBytes;
+			zone.allocations = 0;
+			zone.allocatedBytes = 0;
+			zone.totalItems += zone.items;
+			zone.items = 0;
+			for (int c = 0; c < PerfCounters::Count; ++c) {
+				zone.totalPerf[c] += zone.perf[c];
+				zone.perf[c] = 0;
+			}
+		}
+		for (auto& [index, thread] : m_ThreadPerf) {
+			for (uint64_t& value : thread.window)
+				value = 0;
+		}
+		m_FramesInWindow = 0;
+		m_WindowAllocations = 0;
+		m_WindowAllocatedBytes = 0;
+		m_WindowPeakAllocations = 0;
+		RotateHistogramWindow();
+	}
+
+	void Profiler::DrawStats(StatGroup group) {
+		const uint32_t statCount = m_StatCount.load(std::memory_order_acquire);
+		for (uint32_t i = 1; i < statCount; ++i) {
+			const StatInfo& info = m_StatInfos[i];
+			if (info.group != group)
+				continue;
+
+			const double value = m_StatValues[i].load(std::memory_order_relaxed);
+			char text[64];
+			switch (info.unit) {
+			case StatUnit::Milliseconds: std::snprintf(text, sizeof(text), "%.3f ms", value); break;
+			case StatUnit::Seconds:      std::snprintf(text, sizeof(text), "%.2f s", value); break;
+			case StatUnit::Megabytes:    std::snprintf(text, sizeof(text), "%.0f MB", value); break;
+			case StatUnit::Bytes:
+				if (value >= 1024.0 * 1024.0)
+					std::snprintf(text, sizeof(text), "%.2f MB", value / (1024.0 * 1024.0));
+				else if (value >= 1024.0)
+					std::snprintf(text, sizeof(text), "%.2f KB", value / 1024.0);
+				else
+					std::snprintf(text, sizeof(text), "%.0f Bytes", value);
+				break;
+			default:
+				std::snprintf(text, sizeof(text), value == std::floor(value) ? "%.0f" : "%.2f", value);
+				break;
+			}
+
+			if (info.kind == StatKind::Counter)
+				ImGui::Text("%s: %s (%.1f/s)", info.name.c_str(), text, info.rate);
+			else
+				ImGui::Text("%s: %s", info.name.c_str(), text);
+		}
+	}
+
+	void Profiler::PublishSystemTimings(const std::string& scene, std::map<std::string, SystemTimingEntry> systems) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SystemTimings[scene] = std::move(systems);
+	}
+
+	void Profiler::RemoveSystemTimings(const std::string& scene) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SystemTimings.erase(scene);
+	}
+
+	SystemTimingEntry Profiler::GetSystemTiming(const std::string& scene, const std::string& system) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto systems = m_SystemTimings.find(scene);
+		if (systems == m_SystemTimings.end())
+			return {};
+		auto entry = systems->second.find(system);
+		return entry != systems->second.end() ? entry->second : SystemTimingEntry{};
+	}
+
+	void Profiler::DrawSystemTimings() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (const auto& [scene, systems] : m_SystemTimings) {
+			if (!ImGui::TreeNode(scene.c_str()))
+				continue;
+
+			for (const auto& [name, entry] : systems) {
+				const SystemCallTiming& update = entry.update;
+				const SystemCallTiming& fixed = entry.fixedUpdate;
+				ImGui::Text("%s%s", name.c_str(), entry.enabled ? "" : " (disabled)");
+				ImGui::Indent();
+				ImGui::Text("update: avg %.3f ms, worst %.3f ms (all time %.3f ms), %u/s, %llu calls", update.avgMs, update.worstMs,
+					update.allTimeWorstMs, update.callsPerSecond, static_cast<unsigned long long>(update.calls));
+				if (fixed.calls > 0) {
+					ImGui::Text("fixedUpdate: avg %.3f ms, worst %.3f ms (all time %.3f ms), %u/s, %llu calls", fixed.avgMs, fixed.worstMs,
+						fixed.allTimeWorstMs, fixed.callsPerSecond, static_cast<unsigned long long>(fixed.calls));
+				}
+				ImGui::Unindent();
+			}
+			ImGui::TreePop();
+		}
+	}
+
+	void Profiler::DrawThreadCounters() {
+		if (!PerfCounters::available()) {
+			ImGui::TextUnformatted("perf_event_open failed, check /proc/sys/kernel/perf_event_paranoid");
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		for (const auto& [index, thread] : m_ThreadPerf) {
+			auto name = m_ThreadNames.find(index);
+			ImGui::Text("%s: IPC %.2f, %.1fM cycles/s, %.1fK cache misses/s, %.1fK branch misses/s",
+				name != m_ThreadNames.end() ? name->second.c_str() : ("Thread " + std::to_string(index)).c_str(), thread.ipc,
+				thread.perSecond[PerfCounters::Cycles] / 1e6, thread.perSecond[PerfCounters::CacheMisses] / 1e3, thread.perSecond[PerfCounters::BranchMisses] / 1e3);
+		}
+	}
+
+	void Profiler::DrawZoneTree(uint32_t parentZone, int depth) {
+		// Recursive zones (A in B and B in A) would otherwise never terminate
+		if (depth >= 16)
+			return;
+
+		std::vector<const std::pair<const uint32_t, ZoneStats>*> children;
+		for (const auto& kv : m_Zones) {
+			if (kv.second.parentZone == parentZone)
+				children.push_back(&kv);
+		}
+		std::sort(children.begin(), children.end(), [](auto* a, auto* b) { return a->second.avgFrameMs > b->second.avgFrameMs; });
+
+		for (const auto* kv : children) {
+			const ZoneStats& zone = kv->second;
+			const bool hasChildren = std::any_of(m_Zones.begin(), m_Zones.end(), [&](const auto& other) { return other.second.parentZone == kv->first; });
+
+			char extra[160] = "";
+			int length = 0;
+			if (zone.avgItemsPerFrame > 0.0)
+				length += std::snprintf(extra + length, sizeof(extra) - length, ", %.0f items", zone.avgItemsPerFrame);
+			if constexpr (AllocationTracker::k_enabled)
+				length += std::snprintf(extra + length, sizeof(extra) - length, ", %.1f allocs / %.1f KB", zone.avgAllocsPerFrame, zone.avgAllocBytesPerFrame / 1024.0);
+			if constexpr (PerfCounters::k_enabled) {
+				std::snprintf(extra + length, sizeof(extra) - length, ", IPC %.2f, %.2f cache / %.2f branch misses per %s", zone.ipc,
+					zone.missesPerUnit[0], zone.missesPerUnit[1], zone.avgItemsPerFrame > 0.0 ? "item" : "call");
+			}
+
+			ImGuiTreeNodeFlags flags = hasChildren ? ImGuiTreeNodeFlags_None : ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+			bool open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<intptr_t>(kv->first)), flags, "%s: %.3f ms (%.1f calls, p99 %.3f ms, max %.3f ms%s)",
+				m_Names[zone.nameId].c_str(), zone.avgFrameMs, zone.avgCallsPerFrame, zone.recent.p99Ms, zone.recent.maxMs, extra);
+
+			if (hasChildren && open) {
+				DrawZoneTree(kv->first, depth + 1);
+				ImGui::TreePop();
+			}
+		}
 	}
 	void Profiler::Render() {
 		ImGui::Begin("Profiler");
@@ -103,6 +757,18 @@ namespace engine {
 		}
 		ImGui::NewLine();
 
+		static int captureFrames = 300;
+		if (IsCapturing()) {
+			ImGui::Text("Capturing trace...");
+		}
+		else {
+			ImGui::SetNextItemWidth(100.f);
+			ImGui::InputInt("Frames", &captureFrames);
+			ImGui::SameLine();
+			if (ImGui::Button("Capture trace"))
+				BeginCapture(static_cast<uint32_t>(std::max(captureFrames, 1)), "profile_trace.json");
+		}
+
 		if (m_TabEnabled["CPU"]) {
 			ImGui::PushID(0);
 
@@ -124,10 +790,42 @@ namespace engine {
 					ImGui::PopStyleColor();
 				}
 
-				for (const auto& kv : m_CPUStats) {
-					std::string info = kv.first + ": " + kv.second;
-					ImGui::Text(info.c_str());
+				DrawStats(StatGroup::CPU);
+
+				ImGui::Text("Frame time (last %us): p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms", k_histogramWindows,
+					m_FrameTimeSummary.p50Ms, m_FrameTimeSummary.p95Ms, m_FrameTimeSummary.p99Ms, m_FrameTimeSummary.maxMs);
+				if (!m_FrameTimePlot.empty()) {
+					char overlay[64];
+					std::snprintf(overlay, sizeof(overlay), "%.2f - %.2f ms", LatencyHistogram::bucketLowerBound(m_FrameTimePlotFirst) / 1000.0,
+						LatencyHistogram::bucketUpperBound(m_FrameTimePlotFirst + static_cast<uint32_t>(m_FrameTimePlot.size()) - 1) / 1000.0);
+					ImGui::PlotHistogram("##FrameTimes", m_FrameTimePlot.data(), static_cast<int>(m_FrameTimePlot.size()), 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+				}
+
+				if (ImGui::TreeNode("Zones")) {
+					DrawZoneTree(k_rootId, 0);
+					ImGui::TreePop();
+				}
+
+				if (ImGui::TreeNode("Systems")) {
+					DrawSystemTimings();
+					ImGui::TreePop();
 				}
+
+				if constexpr (PerfCounters::k_enabled) {
+					if (ImGui::TreeNode("Hardware counters")) {
+						DrawThreadCounters();
+						ImGui::TreePop();
+					}
+				}
+
+				uint32_t dropped = 0;
+				{
+					std::lock_guard<std::mutex> lock(m_BufferMutex);
+					for (const auto& buffer : m_ZoneBuffers)
+						dropped += buffer->dropped();
+				}
+				if (dropped > 0)
+					ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Dropped zone events: %u", dropped);
 			}
 
 			ImGui::PopID();
@@ -137,10 +835,7 @@ namespace engine {
 			ImGui::PushID(1);
 
 			if (ImGui::CollapsingHeader("GPU")) {
-				for (const auto& kv : m_GPUStats) {
-					std::string info = kv.first + ": " + kv.second;
-					ImGui::Text(info.c_str());
-				}
+				DrawStats(StatGroup::GPU);
 			}
 
 			ImGui::PopID();
@@ -150,10 +845,15 @@ namespace engine {
 			ImGui::PushID(2);
 
 			if (ImGui::CollapsingHeader("Memory")) {
-				for (const auto& kv : m_MemoryStats) {
-					std::string info = kv.first + ": " + kv.second;
-					ImGui::Text(info.c_str());
+				if constexpr (AllocationTracker::k_enabled) {
+					ImGui::Text("Allocations per frame: %.1f (peak %llu)", m_AvgFrameAllocations, static_cast<unsigned long long>(m_PeakFrameAllocations));
+					ImGui::Text("Allocated per frame: %.1f KB", m_AvgFrameAllocatedBytes / 1024.0);
+				}
+				else {
+					ImGui::TextUnformatted("Build with ENABLE_ALLOC_TRACKING to count allocations");
 				}
+
+				DrawStats(StatGroup::Memory);
 			}
 
 			ImGui::PopID();
@@ -163,10 +863,7 @@ namespace engine {
 			ImGui::PushID(3);
 
 			if (ImGui::CollapsingHeader("General")) {
-				for (const auto& kv : m_GeneralStats) {
-					std::string info = kv.first + ": " + kv.second;
-					ImGui::Text(info.c_str());
-				}
+				DrawStats(StatGroup::General);
 			}
 
 			ImGui::PopID();
@@ -176,14 +873,63 @@ namespace engine {
 	}
 
 	// ProfileScope implementation
+	ProfileScope::ProfileScope(const char* name)
+		: ProfileScope(name, Profiler::k_noCategory) {
+	}
+
 	ProfileScope::ProfileScope(const char* name, Profiler::CPUCategory cat)
-		: m_Name(name), m_Category(cat), m_Start(std::chrono::high_resolution_clock::now()) {
+		: ProfileScope(name, static_cast<uint8_t>(cat)) {
+	}
+
+	ProfileScope::ProfileScope(const char* name, uint8_t category)
+		: m_Name(name), m_Category(category), m_Allocations(0), m_AllocatedBytes(0) {
+		ThreadZoneState& state = t_zoneState;
+		ZonePath* parent = state.depth > 0 ? state.stack[std::min<int>(state.depth, k_maxZoneDepth) - 1] : state.root;
+		m_Path = enterPath(parent, name);
+		if (state.depth < k_maxZoneDepth) {
+			state.stack[state.depth] = m_Path;
+			state.items[state.depth] = 0;
+		}
+		state.depth++;
+
+		if constexpr (AllocationTracker::k_enabled) {
+			const AllocationCounters& counters = AllocationTracker::threadCounters();
+			m_Allocations = counters.allocations;
+			m_AllocatedBytes = counters.bytes;
+		}
+#ifdef ENABLE_PERF_COUNTERS
+		PerfCounters::read(m_Perf);
+#endif
+		m_Start = Profiler::Now();
 	}
 
 	ProfileScope::~ProfileScope() {
-		auto end = std::chrono::high_resolution_clock::now();
-		double ms = std::chrono::duration<double, std::milli>(end - m_Start).count();
-		Profiler::Get().RecordCPU(m_Category, ms);
+		const uint64_t end = Profiler::Now();
+#ifdef ENABLE_PERF_COUNTERS
+		uint64_t perf[PerfCounters::Count];
+		PerfCounters::read(perf);
+#endif
+		ThreadZoneState& state = t_zoneState;
+		state.depth--;
+		const uint32_t items = state.depth < k_maxZoneDepth ? state.items[state.depth] : 0;
+
+		// Inclusive counts, allocations of child zones are part of the parent as well
+		uint64_t allocations = 0;
+		uint64_t allocatedBytes = 0;
+		if constexpr (AllocationTracker::k_enabled) {
+			const AllocationCounters& counters = AllocationTracker::threadCounters();
+			allocations = counters.allocations - m_Allocations;
+			allocatedBytes = counters.bytes - m_AllocatedBytes;
+		}
+
+		if (state.buffer == nullptr)
+			state.buffer = &Profiler::Get().ThreadBuffer();
+		ZoneEvent event{ m_Name, m_Path, m_Start, end, allocatedBytes, static_cast<uint32_t>(allocations), state.depth, m_Category, items };
+#ifdef ENABLE_PERF_COUNTERS
+		for (int c = 0; c < PerfCounters::Count; ++c)
+			event.perf[c] = perf[c] - m_Perf[c];
+#endif
+		state.buffer->push(event);
 	}
 
 }
@@ -4,26 +4,229 @@
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <vector>
+#include <array>
+#include <bit>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstdint>
 #include <mutex>
+#include <future>
+#include <unordered_set>
 #include "imgui/imgui.h"
 #include <glm/glm.hpp>
+#include "PerfCounters.h"
 
 namespace engine {
 
+    // Node of a thread's zone call tree, added by the recording thread the first time a
+    // name is entered below a parent. Nodes are never freed so queued events can point at
+    // them after their thread is gone. The drain only reads name and parent and caches the
+    // zone the path aggregates into.
+    struct ZonePath {
+        const char* name = nullptr;
+        ZonePath* parent = nullptr;
+        std::vector<std::unique_ptr<ZonePath>> children;
+        uint32_t zoneId = 0;
+    };
+
+    // A finished zone as written by the recording thread. Names are never copied,
+    // they have to outlive the profiler (string literals or interned strings).
+    // Allocation counts stay zero unless built with ENABLE_ALLOC_TRACKING, hardware
+    // counters only exist with ENABLE_PERF_COUNTERS.
+    struct ZoneEvent {
+        const char* name;
+        ZonePath* path;
+        uint64_t start;
+        uint64_t end;
+        uint64_t allocatedBytes;
+        uint32_t allocations;
+        uint16_t depth;
+        uint8_t category;
+        uint32_t items;
+#ifdef ENABLE_PERF_COUNTERS
+        uint64_t perf[PerfCounters::Count];
+#endif
+    };
+
+    // Single producer / single consumer ring buffer. The owning thread pushes finished
+    // zones without locking or allocating, Profiler::EndFrame drains it on the main thread.
+    class ZoneBuffer {
+    public:
+        static constexpr uint32_t k_capacity = 1u << 13;
+
+        ZoneBuffer(uint32_t threadIndex, std::thread::id threadId)
+            : m_events(std::make_unique<ZoneEvent[]>(k_capacity)), m_threadIndex(threadIndex), m_threadId(threadId) {}
+
+        bool push(const ZoneEvent& e) {
+            const uint32_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) >= k_capacity) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_events[head & (k_capacity - 1)] = e;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        void drain(F&& fn) {
+            const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            const uint32_t head = m_head.load(std::memory_order_acquire);
+            for (uint32_t i = tail; i != head; ++i)
+                fn(m_events[i & (k_capacity - 1)]);
+            m_tail.store(head, std::memory_order_release);
+        }
+
+        uint32_t threadIndex() const { return m_threadIndex; }
+        std::thread::id threadId() const { return m_threadId; }
+        uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        std::unique_ptr<ZoneEvent[]> m_events;
+        alignas(64) std::atomic<uint32_t> m_head{ 0 };
+        alignas(64) std::atomic<uint32_t> m_tail{ 0 };
+        std::atomic<uint32_t> m_dropped{ 0 };
+        uint32_t m_threadIndex;
+        std::thread::id m_threadId;
+    };
+
+    // Log-linear latency histogram over microseconds, in the spirit of HdrHistogram.
+    // Values below 16 us get their own bucket, above that every power of two is split
+    // into 16 buckets, so any reported value is within ~6% of the real one.
+    class LatencyHistogram {
+    public:
+        static constexpr uint32_t k_subBucketBits = 4;
+        static constexpr uint32_t k_subBuckets = 1u << k_subBucketBits;
+        static constexpr uint32_t k_maxShift = 23;
+        static constexpr uint64_t k_maxValue = static_cast<uint64_t>(k_subBuckets * 2) << k_maxShift; // ~4.5 minutes
+        static constexpr uint32_t k_bucketCount = (k_maxShift + 2) << k_subBucketBits;
+
+        void record(uint64_t us) {
+            m_counts[bucketIndex(us)]++;
+            m_total++;
+            if (us > m_max)
+                m_max = us;
+        }
+
+        void add(const LatencyHistogram& other);
+        void reset();
+
+        // Upper bound of the bucket holding the given percentile (0..100), clamped to the maximum
+        uint64_t percentile(double p) const;
+        uint64_t count() const { return m_total; }
+        uint64_t max() const { return m_max; }
+        uint32_t bucketCount(uint32_t index) const { return m_counts[index]; }
+
+        static uint32_t bucketIndex(uint64_t us) {
+            if (us >= k_maxValue)
+                us = k_maxValue - 1;
+            const uint32_t shift = us < k_subBuckets ? 0 : static_cast<uint32_t>(std::bit_width(us)) - 1 - k_subBucketBits;
+            return (shift << k_subBucketBits) + static_cast<uint32_t>(us >> shift);
+        }
+        static uint64_t bucketLowerBound(uint32_t index) {
+            const uint32_t shift = index < k_subBuckets * 2 ? 0 : (index >> k_subBucketBits) - 1;
+            return static_cast<uint64_t>(index - (shift << k_subBucketBits)) << shift;
+        }
+        static uint64_t bucketUpperBound(uint32_t index) {
+            const uint32_t shift = index < k_subBuckets * 2 ? 0 : (index >> k_subBucketBits) - 1;
+            return bucketLowerBound(index) + (1ull << shift) - 1;
+        }
+
+    private:
+        std::array<uint32_t, k_bucketCount> m_counts{};
+        uint64_t m_total = 0;
+        uint64_t m_max = 0;
+    };
+
+    struct LatencySummary {
+        uint64_t count = 0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    enum class StatGroup : uint8_t { CPU, GPU, Memory, General };
+    enum class StatUnit : uint8_t { None, Milliseconds, Seconds, Bytes, Megabytes };
+    // Gauges hold the last value, counters accumulate and are shown with their rate
+    enum class StatKind : uint8_t { Gauge, Counter };
+
+    // Index into the profiler's stat table, interned once per name
+    struct StatId {
+        uint16_t index = 0;
+    };
+
+    // Window values of one system callback, see SystemTiming
+    struct SystemCallTiming {
+        double avgMs = 0.0;
+        double worstMs = 0.0;
+        double allTimeWorstMs = 0.0;
+        uint32_t callsPerSecond = 0;
+        uint64_t calls = 0;
+    };
+
+    struct SystemTimingEntry {
+        bool enabled = true;
+        SystemCallTiming update;
+        SystemCallTiming fixedUpdate;
+    };
+
     class Profiler {
     public:
         enum class CPUCategory { Rendering, Physics, Update, Fixedupdate };
+        static constexpr uint8_t k_noCategory = 0xFF;
 
         static Profiler& Get();
         void BeginFrame();
         void EndFrame();
 
-        // Recording functions
-        void RecordCPU(CPUCategory category, double durationMs);
-        void SetCPUStatistic(const std::string& name, const std::string& info);
-        void SetGPUStatistic(const std::string& name, const std::string& info);
-        void SetMemoryStatistic(const std::string& name, const std::string& info);
-        void SetGeneralStatistic(const std::string& name, const std::string& info);
+        // Registering takes the lock, returns the same id for the same name (and warns when the
+        // group, unit or kind differ from the first registration). Setting values
+        // is a single atomic store and never formats, that only happens in the UI and exports.
+        StatId RegisterStat(const char* name, StatGroup group, StatUnit unit, StatKind kind = StatKind::Gauge);
+        void SetStat(StatId id, double value) { m_StatValues[id.index].store(value, std::memory_order_relaxed); }
+        void AddStat(StatId id, double delta) { m_StatValues[id.index].fetch_add(delta, std::memory_order_relaxed); }
+        double GetStat(StatId id) const { return m_StatValues[id.index].load(std::memory_order_relaxed); }
+
+        // Zone timestamps are raw steady_clock ticks
+        static uint64_t Now() { return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()); }
+        static double TicksToMs(uint64_t ticks) { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(ticks)).count(); }
+
+        // Names the calling thread in trace captures
+        void SetThreadName(const std::string& name);
+
+        // Adds to the number of items (entities, sprites, bodies...) the innermost zone of the
+        // calling thread processed, so costs can be shown per item
+        static void AddZoneItems(uint32_t count);
+
+        // Returns a copy of the string that lives as long as the profiler, for
+        // zone names that are built at runtime
+        const char* InternString(const std::string& str);
+
+        // Records the next frames and writes them as Chrome Trace Event JSON,
+        // which chrome://tracing and ui.perfetto.dev both open. Every registered stat
+        // is sampled once per frame. The file is written on ThreadPool::global(),
+        // IsCapturing stays true until it is done and new captures are ignored until then.
+        void BeginCapture(uint32_t frames, const std::string& path);
+        bool IsCapturing();
+
+        // Percentiles over the last k_histogramWindows seconds. Frame time is measured
+        // from one EndFrame to the next, zones per call and merged over all parents.
+        static constexpr uint32_t k_histogramWindows = 10;
+        LatencySummary GetFrameTimeSummary();
+        LatencySummary GetZoneSummary(const std::string& name);
+
+        // Writes the histograms of the whole session as JSON
+        void DumpHistograms(const std::string& path);
+
+        // System timings by scene and system name. A scene replaces all of its rows once per
+        // second, SceneManager removes them when the scene is unloaded.
+        void PublishSystemTimings(const std::string& scene, std::map<std::string, SystemTimingEntry> systems);
+        void RemoveSystemTimings(const std::string& scene);
+        // Default entry when the scene or system has not published yet
+        SystemTimingEntry GetSystemTiming(const std::string& scene, const std::string& system);
 
         // UI toggles
         void ToggleTab(const std::string& tabName, bool enabled);
@@ -37,6 +240,17 @@ namespace engine {
 
         void ResetFrameData();
         void UpdateAggregates();
+        ZoneBuffer& ThreadBuffer();
+        void DrainZones();
+        void RecordCaptureFrame(uint64_t frameEnd, uint64_t frameAllocations);
+        void FinishCapture();
+        uint32_t InternName(const char* name);
+        uint32_t ResolveZone(ZonePath* path);
+        void DrawZoneTree(uint32_t parentZone, int depth);
+        void RotateHistogramWindow();
+        void DrawStats(StatGroup group);
+        void DrawSystemTimings();
+        void DrawThreadCounters();
 
         // Data structures
         struct StatEntry {
@@ -45,45 +259,191 @@ namespace engine {
             double lastValue;
         };
 
+        // One histogram per second, the oldest one is recycled every window and
+        // folded into the session total first.
+        struct RollingHistogram {
+            std::array<LatencyHistogram, k_histogramWindows> windows;
+            LatencyHistogram total;
+
+            void record(uint64_t us, uint32_t window) { windows[window].record(us); }
+            LatencyHistogram merged() const;
+            LatencySummary summary() const;
+        };
+
+        // Zones are aggregated per call path so the same zone below different
+        // parents shows up as separate nodes in the tree. parentZone is the
+        // m_Zones key of the enclosing zone, parentId only names it for exports.
+        struct ZoneStats {
+            uint32_t nameId;
+            uint32_t parentId;
+            uint32_t parentZone;
+            double accumulatedMs = 0.0;
+            uint32_t calls = 0;
+            double avgFrameMs = 0.0;
+            double avgCallsPerFrame = 0.0;
+            uint64_t allocations = 0;
+            uint64_t allocatedBytes = 0;
+            double avgAllocsPerFrame = 0.0;
+            double avgAllocBytesPerFrame = 0.0;
+            uint64_t totalAllocations = 0;
+            uint64_t totalAllocatedBytes = 0;
+            uint64_t items = 0;
+            uint64_t totalItems = 0;
+            double avgItemsPerFrame = 0.0;
+            uint64_t perf[PerfCounters::Count] = {};
+            uint64_t totalPerf[PerfCounters::Count] = {};
+            double ipc = 0.0;
+            double missesPerUnit[2] = {};   // cache and branch misses per item, per call without items
+            RollingHistogram histogram;
+            LatencySummary recent;
+        };
+
+        static constexpr uint32_t k_rootId = 0;
+
         std::map<std::string, StatEntry> m_CPUStatEntries;
-        std::map<std::string, std::string> m_CPUStats;
 
-        std::map<std::string, std::string> m_GPUStats;
-        std::map<std::string, std::string> m_MemoryStats;
-        std::map<std::string, std::string> m_GeneralStats;
+        // Slot 0 swallows registrations past k_maxStats and is never shown
+        static constexpr uint32_t k_maxStats = 256;
+        struct StatInfo {
+            std::string name;
+            StatGroup group;
+            StatUnit unit;
+            StatKind kind;
+            double lastCounterValue = 0.0;
+            double rate = 0.0;
+        };
+        std::array<std::atomic<double>, k_maxStats> m_StatValues{};
+        std::array<StatInfo, k_maxStats> m_StatInfos;
+        std::atomic<uint32_t> m_StatCount{ 1 };
+        std::unordered_map<std::string, uint16_t> m_StatLookup;
+
+        std::unordered_set<std::string> m_InternedStrings;
+
+        // Hardware counters summed over the top level zones of each thread
+        struct ThreadPerfStats {
+            uint64_t window[PerfCounters::Count] = {};
+            double perSecond[PerfCounters::Count] = {};
+            double ipc = 0.0;
+        };
+        std::unordered_map<uint32_t, ThreadPerfStats> m_ThreadPerf;
 
         std::unordered_map<std::string, bool> m_TabEnabled;
 
+        std::map<std::string, std::map<std::string, SystemTimingEntry>> m_SystemTimings;
+
+        std::vector<std::unique_ptr<ZoneBuffer>> m_ZoneBuffers;
+        std::mutex m_BufferMutex;
+        std::unordered_map<const char*, uint32_t> m_NameIds;
+        std::unordered_map<std::string, uint32_t> m_NameLookup;
+        std::vector<std::string> m_Names;
+        // (parent zone << 32 | name id) to zone id, ids start at 1 so k_rootId is never a zone
+        std::unordered_map<uint64_t, uint32_t> m_ZoneIds;
+        std::unordered_map<uint32_t, ZoneStats> m_Zones;
+        uint32_t m_FramesInWindow = 0;
+        uint64_t m_FrameStart = 0;
+        uint64_t m_LastFrameEnd = 0;
+
+        RollingHistogram m_FrameTimes;
+        LatencySummary m_FrameTimeSummary;
+        std::vector<float> m_FrameTimePlot;
+        uint32_t m_FrameTimePlotFirst = 0;
+        uint32_t m_HistogramWindow = 0;
+
+        // Allocations of all threads between two EndFrame calls
+        uint64_t m_LastAllocations = 0;
+        uint64_t m_LastAllocatedBytes = 0;
+        uint64_t m_WindowAllocations = 0;
+        uint64_t m_WindowAllocatedBytes = 0;
+        uint64_t m_WindowPeakAllocations = 0;
+        double m_AvgFrameAllocations = 0.0;
+        double m_AvgFrameAllocatedBytes = 0.0;
+        uint64_t m_PeakFrameAllocations = 0;
+        uint64_t m_SessionFrames = 0;
+
+        struct CapturedZone {
+            ZoneEvent event;
+            uint32_t threadIndex;
+        };
+        struct CapturedCounter {
+            const char* name;
+            uint32_t threadIndex;
+            uint64_t time;
+            double value;
+        };
+
+        // A finished capture, moved to the worker that writes it
+        struct CaptureData {
+            std::string path;
+            uint64_t start;
+            std::vector<CapturedZone> zones;
+            std::vector<CapturedCounter> counters;
+            std::unordered_map<uint32_t, std::string> threadNames;
+        };
+        static void WriteCapture(const CaptureData& capture);
+
+        std::vector<CapturedZone> m_CaptureZones;
+        std::vector<CapturedCounter> m_CaptureCounters;
+        std::unordered_map<uint32_t, std::string> m_ThreadNames;
+        std::string m_CapturePath;
+        uint32_t m_CaptureFramesLeft = 0;
+        uint64_t m_CaptureStart = 0;
+        std::future<void> m_CaptureWrite;
+
         std::chrono::high_resolution_clock::time_point m_SecondTimer;
         std::mutex m_Mutex;
+
+        friend struct ProfileScope;
     };
 
 
 
-    // RAII scope helper
+    // RAII scope helper, records a nested zone into the calling thread's buffer
     struct ProfileScope {
+        explicit ProfileScope(const char* name);
         ProfileScope(const char* name, Profiler::CPUCategory cat);
         ~ProfileScope();
 
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
     private:
-        const char* m_Name;
-        Profiler::CPUCategory m_Category;
-        std::chrono::high_resolution_clock::time_point m_Start;
+        ProfileScope(const char* name, uint8_t category);
 
+        const char* m_Name;
+        ZonePath* m_Path;
+        uint8_t m_Category;
+        uint64_t m_Start;
+        uint64_t m_Allocations;
+        uint64_t m_AllocatedBytes;
+#ifdef ENABLE_PERF_COUNTERS
+        uint64_t m_Perf[PerfCounters::Count];
+#endif
     };
 
     // Profiling macros
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+    // Interns the stat on first use of the call site, later calls only read a static
+#define PROFILE_STAT_ID(name, group, unit, kind) ([]() { \
+        static const ::engine::StatId id = ::engine::Profiler::Get().RegisterStat(name, ::engine::StatGroup::group, ::engine::StatUnit::unit, ::engine::StatKind::kind); \
+        return id; }())
+
 #ifdef ENABLE_PROFILING
-#define PROFILE_CPU(name, cat) ProfileScope scope##__LINE__(name, cat)
-#define SET_CPU_STAT(name, info)     ::engine::Profiler::Get().SetCPUStatistic(name, info)
-#define SET_GPU_STAT(name, info)     ::engine::Profiler::Get().SetGPUStatistic(name, info)
-#define SET_MEM_STAT(name, info)     ::engine::Profiler::Get().SetMemoryStatistic(name, info)
-#define SET_GEN_STAT(name, info)     ::engine::Profiler::Get().SetGeneralStatistic(name, info)
+#define PROFILE_CPU(name, cat) ::engine::ProfileScope PROFILE_CONCAT(scope, __LINE__)(name, cat)
+#define PROFILE_ZONE(name) ::engine::ProfileScope PROFILE_CONCAT(zone, __LINE__)(name)
+#define PROFILE_ZONE_ITEMS(count) ::engine::Profiler::AddZoneItems(static_cast<uint32_t>(count))
+#define SET_CPU_STAT(name, value, unit)     ::engine::Profiler::Get().SetStat(PROFILE_STAT_ID(name, CPU, unit, Gauge), static_cast<double>(value))
+#define SET_GPU_STAT(name, value, unit)     ::engine::Profiler::Get().SetStat(PROFILE_STAT_ID(name, GPU, unit, Gauge), static_cast<double>(value))
+#define SET_MEM_STAT(name, value, unit)     ::engine::Profiler::Get().SetStat(PROFILE_STAT_ID(name, Memory, unit, Gauge), static_cast<double>(value))
+#define SET_GEN_STAT(name, value, unit)     ::engine::Profiler::Get().SetStat(PROFILE_STAT_ID(name, General, unit, Gauge), static_cast<double>(value))
 #else
 #define PROFILE_CPU(name, cat)
-#define SET_CPU_STAT(name, info)
-#define SET_GPU_STAT(name, info)   
-#define SET_MEM_STAT(name, info)
-#define SET_GEN_STAT(name, info)
+#define PROFILE_ZONE(name)
+#define PROFILE_ZONE_ITEMS(count)
+#define SET_CPU_STAT(name, value, unit)
+#define SET_GPU_STAT(name, value, unit)
+#define SET_MEM_STAT(name, value, unit)
+#define SET_GEN_STAT(name, value, unit)
 #endif
-}
\ No newline at end of file
+}
@@ -83,12 +83,12 @@ namespace graphics {
 
 		camera.updateViewYXZ();
 
-		auto view = registry.view<engine::Transform2D, SpriteRenderer>();
+		auto group = scene.renderGroup();
 
-		if (view.size_hint() == 0) {
-			SET_GPU_STAT("Batches", std::to_string(0));
-			SET_GPU_STAT("Triangles", std::to_string(0));
-			SET_GPU_STAT("Vertices", std::to_string(0));
+		if (group.size() == 0) {
+			SET_GPU_STAT("Batches", 0, None);
+			SET_GPU_STAT("Triangles", 0, None);
+			SET_GPU_STAT("Vertices", 0, None);
 			return;
 		}
 
@@ -104,21 +104,42 @@ namespace graphics {
 
 		// 1) Sichtbare Instanzen sammeln
 		std::vector<SpriteInstance> instances;
-		instances.reserve(view.size_hint());
+		instances.reserve(group.size());
 		int renderObjects = 0;
-		for (auto [ent, transform, sprite] : view.each()) {
-			if (sprite.color.w <= 0.0f) continue;
-			if (!AABB::intersects(AABB::create(transform), camAABB)) continue;
-
-			instances.push_back({ transform.mat3(), sprite.color, sprite.texture, sprite.layer });
-			++renderObjects;
+		// Once about a third of the group is on screen the linear walk over the packed sprites beats
+		// the index query and its per hit lookups. Last frame's count decides, the camera rarely
+		// jumps between a sparse and a dense view.
+		if (scene.visibleSprites() * 3 >= group.size()) {
+			PROFILE_ZONE("Render::CollectGroup");
+			PROFILE_ZONE_ITEMS(group.size());
+			for (auto [ent, sprite, tr] : group.each()) {
+				if (sprite.color.w <= 0.0f || !AABB::intersects(AABB::create(tr), camAABB)) continue;
+
+				instances.push_back({ tr.mat3(), sprite.color, sprite.texture, sprite.layer });
+				++renderObjects;
+			}
 		}
+		else {
+			PROFILE_ZONE("Render::CollectIndex");
+			// Only what the spatial index has on screen, matrices are cached in the transforms
+			uint32_t candidates = 0;
+			scene.spatialIndex().queryRect(camAABB, [&](entt::entity ent, const AABB&) {
+				++candidates;
+				const SpriteRenderer* sprite = registry.try_get<SpriteRenderer>(ent);
+				if (sprite == nullptr || sprite->color.w <= 0.0f) return;
+
+				instances.push_back({ registry.get<engine::Transform2D>(ent).mat3(), sprite->color, sprite->texture, sprite->layer });
+				++renderObjects;
+			});
+			PROFILE_ZONE_ITEMS(candidates);
+		}
+		scene.setVisibleSprites(renderObjects);
 
 
 		if (renderObjects == 0) {
-			SET_GPU_STAT("Batches", std::to_string(0));
-			SET_GPU_STAT("Triangles", std::to_string(0));
-			SET_GPU_STAT("Vertices", std::to_string(0));
+			SET_GPU_STAT("Batches", 0, None);
+			SET_GPU_STAT("Triangles", 0, None);
+			SET_GPU_STAT("Vertices", 0, None);
 			return;
 		}
 
@@ -127,8 +148,12 @@ namespace graphics {
 		std::unordered_map<short, std::unordered_map<TextureHandle, std::vector<SpriteInstance>>> buckets;
 		// Dann passt reserve:
 		buckets.reserve(16);
-		for (auto& inst : instances) {
-			buckets[inst.layer][inst.texture].push_back(inst);
+		{
+			PROFILE_ZONE("Render::Buckets");
+			PROFILE_ZONE_ITEMS(instances.size());
+			for (auto& inst : instances) {
+				buckets[inst.layer][inst.texture].push_back(inst);
+			}
 		}
 
 		// 3) Layers sortieren
@@ -152,6 +177,8 @@ namespace graphics {
 
 		float start = engine::Time::elapsedTime();
 		// 6) Durch alle Layers und Texturen iterieren
+		PROFILE_ZONE("Render::Draw");
+		PROFILE_ZONE_ITEMS(renderObjects);
 		for (short layer : layers) {
 			auto& texMap = buckets[layer];
 			for (auto& [texture, vec] : texMap) {
@@ -189,11 +216,10 @@ namespace graphics {
 			}
 		}
 
-		SET_GPU_STAT("Render", std::to_string(engine::Time::elapsedTime() - start) + "ms");
-		SET_GPU_STAT("Triangles", std::to_string(0));
-		SET_GPU_STAT("Batches", std::to_string(batches));
-		SET_GPU_STAT("Triangles", std::to_string(renderObjects * 2));
-		SET_GPU_STAT("Vertices", std::to_string(renderObjects * 4));
+		SET_GPU_STAT("Render", (engine::Time::elapsedTime() - start) * 1000.f, Milliseconds);
+		SET_GPU_STAT("Batches", batches, None);
+		SET_GPU_STAT("Triangles", renderObjects * 2, None);
+		SET_GPU_STAT("Vertices", renderObjects * 4, None);
 
 		// 8) Cleanup
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -0,0 +1,104 @@
+#include "SaveSystem.h"
+#include "SceneSnapshot.h"
+#include "JobSystem.h"
+#include "Core/Scene.h"
+#include "Core/SceneManager.h"
+#include "Core/Profiler.h"
+#include "Utils/Debug.h"
+#include <chrono>
+
+namespace engine {
+	std::optional<SaveSystem::Job> SaveSystem::s_job;
+	std::atomic<float> SaveSystem::s_progress{ 0.f };
+	std::mutex SaveSystem::s_requestMutex;
+	std::optional<std::filesystem::path> SaveSystem::s_requestedPath;
+
+	bool SaveSystem::saveAsync(Scene& scene, const std::filesystem::path& path, Callback onComplete, bool compress) {
+		if (s_job) {
+			Debug::logWarning("Save to " + path.string() + " ignored, a save is still running");
+			return false;
+		}
+		PROFILE_ZONE("SaveSystem::Capture");
+
+		auto result = std::make_shared<SaveResult>();
+		result->path = path;
+
+		const auto captureStart = std::chrono::steady_clock::now();
+		auto capture = std::make_shared<SceneSnapshot::Capture>(SceneSnapshot::captureBlocks(scene.registry()));
+		result->captureMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - captureStart).count();
+
+		s_progress.store(0.f, std::memory_order_relaxed);
+		std::future<void> future = ThreadPool::global().schedule([result, capture, compress] {
+			const auto writeStart = std::chrono::steady_clock::now();
+			try {
+				const std::vector<char> data = SceneSnapshot::encode(*capture, compress, &s_progress);
+				SceneSnapshot::writeFile(result->path, data);
+				result->bytes = data.size();
+				result->success = true;
+			}
+			catch (const std::exception& e) {
+				result->error = e.what();
+			}
+			result->writeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - writeStart).count();
+			s_progress.store(1.f, std::memory_order_relaxed);
+		});
+
+		s_job = Job{ std::move(result), std::move(onComplete), std::move(future) };
+		return true;
+	}
+
+	void SaveSystem::requestSave(const std::filesystem::path& path) {
+		std::lock_guard lock(s_requestMutex);
+		s_requestedPath = path;
+	}
+
+	bool SaveSystem::isSaving() {
+		return s_job.has_value();
+	}
+
+	float SaveSystem::progress() {
+		return s_job ? s_progress.load(std::memory_order_relaxed) : 1.f;
+	}
+
+	void SaveSystem::finish(Job& job) {
+		job.future.get();
+		const SaveResult& result = *job.result;
+		if (result.success) {
+			Debug::log("Saved " + result.path.string() + " (" + std::to_string(result.bytes / 1024) + " KiB, capture "
+				+ std::to_string(result.captureMs) + " ms, write " + std::to_string(result.writeMs) + " ms)");
+		}
+		else {
+			Debug::logError("Saving " + result.path.string() + " failed: " + result.error);
+		}
+
+		if (job.onComplete)
+			job.onComplete(result);
+	}
+
+	void SaveSystem::poll() {
+		if (s_job && s_job->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			Job job = std::move(*s_job);
+			s_job.reset();
+			finish(job);
+		}
+
+		std::optional<std::filesystem::path> requested;
+		{
+			std::lock_guard lock(s_requestMutex);
+			if (s_requestedPath && !s_job)
+				requested.swap(s_requestedPath);
+		}
+		if (requested)
+			saveAsync(SceneManager::getActiveScene(), *requested);
+	}
+
+	void SaveSystem::waitForCompletion() {
+		if (!s_job)
+			return;
+
+		Job job = std::move(*s_job);
+		s_job.reset();
+		job.future.wait();
+		finish(job);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace engine {
+	class Scene;
+
+	struct SaveResult {
+		std::filesystem::path path;
+		bool success = false;
+		std::string error;
+		size_t bytes = 0;
+		float captureMs = 0.f;  // Time the main thread was blocked
+		float writeMs = 0.f;    // Encode, compress and fsync on the worker
+	};
+
+	// Background scene saves. The registry is copied on the main thread into one flat block per
+	// component type (a memcpy or stored record per component, see ComponentReflect), encoding,
+	// compression and the fsync run on a ThreadPool worker, so the frame only pays for the copy.
+	// Only one save runs at a time.
+	class SaveSystem {
+	public:
+		using Callback = std::function<void(const SaveResult&)>;
+
+		// Main thread only. Returns false if a save is still running
+		static bool saveAsync(Scene& scene, const std::filesystem::path& path, Callback onComplete = nullptr, bool compress = true);
+		// Thread safe, the active scene is saved on the next poll()
+		static void requestSave(const std::filesystem::path& path);
+
+		static bool isSaving();
+		// 0..1 of the running save
+		static float progress();
+
+		// Starts requested saves and reports finished ones, called once per frame
+		static void poll();
+		// Blocks until the running save is on disk and reports it
+		static void waitForCompletion();
+
+	private:
+		struct Job {
+			std::shared_ptr<SaveResult> result;
+			Callback onComplete;
+			std::future<void> future;
+		};
+
+		static void finish(Job& job);
+
+		static std::optional<Job> s_job;
+		static std::atomic<float> s_progress;
+
+		static std::mutex s_requestMutex;
+		static std::optional<std::filesystem::path> s_requestedPath;
+	};
+}
@@ -1,11 +1,61 @@
 ﻿#include "Scene.h"
+#include "Core/Profiler.h"
+#include "Physics/PhysicsSystem.h"
+#include <typeinfo>
+#include <algorithm>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
 
 namespace engine {
+	namespace {
+		// "class engine::PhysicsSystem" -> "PhysicsSystem"
+		std::string systemTypeName(const std::type_info& type) {
+			std::string name = type.name();
+#if defined(__GNUG__)
+			int status = 0;
+			if (char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status)) {
+				name = demangled;
+				std::free(demangled);
+			}
+#endif
+			for (const char* prefix : { "class ", "struct " }) {
+				if (name.rfind(prefix, 0) == 0)
+					name.erase(0, std::char_traits<char>::length(prefix));
+			}
+			const size_t scope = name.rfind("::");
+			if (scope != std::string::npos)
+				name.erase(0, scope + 2);
+			return name;
+		}
+	}
+
 	Box2DWorld Scene::s_physicsWorld = {};
 
-	Scene::Scene(const std::string& name) : k_sceneName(name) {}
+	Scene::Scene(const std::string& name) : k_sceneName(name) {
+		m_registry.on_construct<Transform2D>().connect<&Scene::onTransformConstructed>(*this);
+		m_registry.on_destroy<Transform2D>().connect<&Scene::onTransformDestroyed>(*this);
+		m_registry.on_update<Transform2D>().connect<&Scene::onTransformConstructed>(*this);
+		m_registry.on_construct<Hierarchy>().connect<&Scene::onHierarchyConstructed>(*this);
+		m_registry.on_destroy<Hierarchy>().connect<&Scene::onHierarchyDestroyed>(*this);
+		m_registry.on_construct<Inactive>().connect<&Scene::onInactiveConstructed>(*this);
+		m_registry.on_destroy<Inactive>().connect<&Scene::onInactiveDestroyed>(*this);
+		// Before any component exists, the groups then grow with the pools
+		renderGroup();
+		PhysicsSystem::bodies(m_registry);
+	}
 
-	Scene::~Scene() = default;
+	Scene::~Scene() {
+		m_registry.on_construct<Transform2D>().disconnect(*this);
+		m_registry.on_destroy<Transform2D>().disconnect(*this);
+		m_registry.on_update<Transform2D>().disconnect(*this);
+		m_registry.on_construct<Hierarchy>().disconnect(*this);
+		m_registry.on_destroy<Hierarchy>().disconnect(*this);
+		m_registry.on_construct<Inactive>().disconnect(*this);
+		m_registry.on_destroy<Inactive>().disconnect(*this);
+		TransformChangeList::close(m_transformChanges);
+	}
 
 	entt::entity Scene::createEntity() { return	 m_registry.create(); }
 
@@ -43,7 +93,198 @@ namespace engine {
 		return camera;
 	}
 
-	void Scene::destroyEntity(entt::entity handle) { m_registry.destroy(handle); }
+	void Scene::destroyEntity(entt::entity handle) {
+		// Children go with their parent, deepest first
+		if (m_registry.all_of<Hierarchy>(handle)) {
+			std::vector<entt::entity> descendants;
+			std::vector<entt::entity> open{ handle };
+			while (!open.empty()) {
+				const entt::entity entity = open.back();
+				open.pop_back();
+				forEachChild(entity, [&](entt::entity child) {
+					descendants.push_back(child);
+					open.push_back(child);
+				});
+			}
+			for (auto it = descendants.rbegin(); it != descendants.rend(); ++it)
+				m_registry.destroy(*it);
+		}
+		m_registry.destroy(handle);
+	}
+
+	void Scene::setParent(entt::entity child, entt::entity parent, bool keepWorldTransform) {
+		if (!m_registry.all_of<Transform2D>(child) || (parent != entt::null && !m_registry.all_of<Transform2D>(parent)))
+			throw std::runtime_error("setParent: child and parent need a Transform2D");
+		for (entt::entity ancestor = parent; ancestor != entt::null;) {
+			if (ancestor == child)
+				throw std::runtime_error("setParent: the parent is the child itself or one of its descendants");
+			const Hierarchy* node = m_registry.try_get<Hierarchy>(ancestor);
+			ancestor = node ? node->parent : entt::null;
+		}
+
+		// Emplace both before taking references, emplacing can move the storage
+		m_registry.get_or_emplace<Hierarchy>(child);
+		if (parent != entt::null)
+			m_registry.get_or_emplace<Hierarchy>(parent);
+
+		Hierarchy& node = m_registry.get<Hierarchy>(child);
+		unlinkFromParent(node);
+
+		const Transform2D& world = m_registry.get<Transform2D>(child);
+		node.m_localPosition = world.position();
+		node.m_localScale = world.scale();
+		node.m_localRotation = world.rotation();
+		node.m_localDirty = true;
+		TransformChangeList::record(m_transformChanges, static_cast<uint32_t>(child));
+
+		uint32_t depth = 0;
+		if (parent != entt::null) {
+			Hierarchy& parentNode = m_registry.get<Hierarchy>(parent);
+			node.parent = parent;
+			node.nextSibling = parentNode.firstChild;
+			if (parentNode.firstChild != entt::null)
+				m_registry.get<Hierarchy>(parentNode.firstChild).prevSibling = child;
+			parentNode.firstChild = child;
+			++parentNode.childCount;
+			depth = parentNode.depth + 1;
+
+			if (keepWorldTransform) {
+				// Inverse of the propagation, so the first pass puts the child back where it is
+				const Transform2D& parentWorld = m_registry.get<Transform2D>(parent);
+				const glm::vec2 delta = world.position() - parentWorld.position();
+				const float c = parentWorld.cosRotation();
+				const float s = parentWorld.sinRotation();
+				const glm::vec2 parentScale = glm::vec2{
+					parentWorld.scale().x != 0.f ? parentWorld.scale().x : 1.f,
+					parentWorld.scale().y != 0.f ? parentWorld.scale().y : 1.f };
+				node.m_localPosition = glm::vec2{ c * delta.x + s * delta.y, -s * delta.x + c * delta.y } / parentScale;
+				node.m_localScale = world.scale() / parentScale;
+				node.m_localRotation = world.rotation() - parentWorld.rotation();
+			}
+		}
+
+		updateDepths(child, depth);
+	}
+
+	entt::entity Scene::getParent(entt::entity handle) const {
+		const Hierarchy* node = m_registry.try_get<Hierarchy>(handle);
+		return node ? node->parent : entt::null;
+	}
+
+	void Scene::unlinkFromParent(Hierarchy& node) {
+		if (node.parent == entt::null) return;
+
+		Hierarchy& parentNode = m_registry.get<Hierarchy>(node.parent);
+		if (node.prevSibling != entt::null)
+			m_registry.get<Hierarchy>(node.prevSibling).nextSibling = node.nextSibling;
+		else
+			parentNode.firstChild = node.nextSibling;
+		if (node.nextSibling != entt::null)
+			m_registry.get<Hierarchy>(node.nextSibling).prevSibling = node.prevSibling;
+		--parentNode.childCount;
+
+		node.parent = entt::null;
+		node.prevSibling = entt::null;
+		node.nextSibling = entt::null;
+	}
+
+	void Scene::updateDepths(entt::entity root, uint32_t depth) {
+		m_registry.get<Hierarchy>(root).depth = depth;
+		std::vector<entt::entity> open{ root };
+		while (!open.empty()) {
+			const entt::entity entity = open.back();
+			open.pop_back();
+			const uint32_t childDepth = m_registry.get<Hierarchy>(entity).depth + 1;
+			forEachChild(entity, [&](entt::entity child) {
+				m_registry.get<Hierarchy>(child).depth = childDepth;
+				open.push_back(child);
+			});
+		}
+	}
+
+	void Scene::onHierarchyConstructed(entt::registry& registry, entt::entity entity) {
+		// New nodes start dirty, recorded so the next pass builds their world transform
+		Hierarchy& node = registry.get<Hierarchy>(entity);
+		node.m_changeList = m_transformChanges;
+		node.m_entity = static_cast<uint32_t>(entity);
+		TransformChangeList::record(m_transformChanges, node.m_entity);
+	}
+
+	void Scene::onHierarchyDestroyed(entt::registry& registry, entt::entity entity) {
+		Hierarchy& node = registry.get<Hierarchy>(entity);
+		unlinkFromParent(node);
+
+		// Children that outlive their parent become roots where they are
+		forEachChild(entity, [&](entt::entity child) {
+			Hierarchy& childNode = registry.get<Hierarchy>(child);
+			const Transform2D* world = registry.try_get<Transform2D>(child);
+			childNode.parent = entt::null;
+			childNode.prevSibling = entt::null;
+			childNode.nextSibling = entt::null;
+			if (world) {
+				childNode.m_localPosition = world->position();
+				childNode.m_localScale = world->scale();
+				childNode.m_localRotation = world->rotation();
+			}
+			updateDepths(child, 0);
+		});
+		node.firstChild = entt::null;
+		node.childCount = 0;
+	}
+
+	bool Scene::rebuildFromParent(entt::entity entity, Hierarchy& node) {
+		// A changed parent has a new version
+		const Transform2D& parent = m_registry.get<Transform2D>(node.parent);
+		if (!node.m_localDirty && node.m_parentVersion == parent.version()) return false;
+
+		const float c = parent.cosRotation();
+		const float s = parent.sinRotation();
+		const glm::vec2 scaled = parent.scale() * node.m_localPosition;
+		const glm::vec2 position = parent.position() + glm::vec2{ c * scaled.x - s * scaled.y, s * scaled.x + c * scaled.y };
+
+		m_registry.get<Transform2D>(entity).set(position, parent.scale() * node.m_localScale, parent.rotation() + node.m_localRotation);
+		node.m_parentVersion = parent.version();
+		node.m_localDirty = false;
+		return true;
+	}
+
+	void Scene::propagateHierarchy(const std::vector<uint32_t>& recorded) {
+		if (m_registry.view<Hierarchy>().empty()) return;
+		PROFILE_ZONE("Scene::PropagateHierarchy");
+
+		// Nodes that moved or got a new local transform, shallowest first so a subtree below
+		// two of them is usually walked once
+		m_hierarchySeeds.clear();
+		for (uint32_t id : recorded) {
+			const entt::entity entity = static_cast<entt::entity>(id);
+			if (!m_registry.valid(entity)) continue;
+			if (const Hierarchy* node = m_registry.try_get<Hierarchy>(entity))
+				m_hierarchySeeds.emplace_back(node->depth, entity);
+		}
+		std::sort(m_hierarchySeeds.begin(), m_hierarchySeeds.end());
+		m_hierarchySeeds.erase(std::unique(m_hierarchySeeds.begin(), m_hierarchySeeds.end()), m_hierarchySeeds.end());
+
+		uint32_t updated = 0;
+		auto open = [&](entt::entity child) { m_hierarchyOpen.push_back(child); };
+		for (const auto& [depth, seed] : m_hierarchySeeds) {
+			Hierarchy& node = m_registry.get<Hierarchy>(seed);
+			if (node.parent == entt::null)
+				node.m_localDirty = false;   // Roots have no parent to be relative to
+			else if (rebuildFromParent(seed, node))
+				++updated;
+
+			// The seed's world transform changed, below it only subtrees whose parent got a new version
+			forEachChild(seed, open);
+			while (!m_hierarchyOpen.empty()) {
+				const entt::entity entity = m_hierarchyOpen.back();
+				m_hierarchyOpen.pop_back();
+				if (!rebuildFromParent(entity, m_registry.get<Hierarchy>(entity))) continue;
+				++updated;
+				forEachChild(entity, open);
+			}
+		}
+		PROFILE_ZONE_ITEMS(updated);
+	}
 
 	void Scene::awakeSystems() {
 		for (auto& s : m_systems)
@@ -68,33 +309,98 @@ namespace engine {
 		}
 	}
 
+	void Scene::registerSystem(ISystem& system) {
+		system.m_name = systemTypeName(typeid(system));
+		// Zone names have to outlive the system, the profiler keeps interned copies
+		system.m_updateZone = Profiler::Get().InternString(system.m_name + "::update");
+		system.m_fixedUpdateZone = Profiler::Get().InternString(system.m_name + "::fixedUpdate");
+	}
+
+	CommandBuffer& Scene::commands() {
+		const std::thread::id thread = std::this_thread::get_id();
+		std::lock_guard lock(m_commandMutex);
+		for (auto& [id, buffer] : m_commandBuffers) {
+			if (id == thread) return *buffer;
+		}
+		m_commandBuffers.emplace_back(thread, std::make_unique<CommandBuffer>());
+		return *m_commandBuffers.back().second;
+	}
+
+	void Scene::flushCommands() {
+		std::vector<CommandBuffer*> buffers;
+		{
+			// Not held while flushing, deferred calls may fetch a buffer themselves
+			std::lock_guard lock(m_commandMutex);
+			buffers.reserve(m_commandBuffers.size());
+			for (auto& [id, buffer] : m_commandBuffers)
+				buffers.push_back(buffer.get());
+		}
+		// In the order the threads first recorded, which keeps a single threaded frame deterministic
+		for (CommandBuffer* buffer : buffers) {
+			try {
+				buffer->flush(*this);
+			}
+			catch (const std::runtime_error& e) {
+				Debug::logError(e.what());
+			}
+		}
+	}
+
+	void Scene::publishSystemTimings() {
+		auto window = [](const SystemTiming& timing) {
+			return SystemCallTiming{ timing.avgMs, timing.worstMs, timing.allTimeWorstMs, timing.callsPerSecond, timing.calls };
+		};
+
+		std::map<std::string, SystemTimingEntry> systems;
+		for (auto& s : m_systems) {
+			s->m_updateTiming.publishWindow();
+			s->m_fixedUpdateTiming.publishWindow();
+			systems[s->m_name] = SystemTimingEntry{ s->m_enabled, window(s->m_updateTiming), window(s->m_fixedUpdateTiming) };
+		}
+		Profiler::Get().PublishSystemTimings(k_sceneName, std::move(systems));
+	}
+
 	void Scene::updateSystems() {
+		const auto now = std::chrono::steady_clock::now();
+		if (now - m_timingWindowStart >= std::chrono::seconds(1)) {
+			publishSystemTimings();
+			m_timingWindowStart = now;
+		}
+
 		for (auto& s : m_systems)
 		{
 			if (s->m_enabled)
 			{
+				const uint64_t start = Profiler::Now();
 				try {
-					s->update(*this);
-				}
-				catch (std::runtime_error e) {
-					Debug::logError(std::string(e.what()));
+					PROFILE_ZONE(s->m_updateZone);
+					s->update(*this);
+				}
+				catch (std::runtime_error e) {
+					Debug::logError(std::string(e.what()));
 				}
+				s->m_updateTiming.record(Profiler::TicksToMs(Profiler::Now() - start));
 			}
 		}
+		flushCommands();
 	}
 
 	void Scene::fixedUpdateSystems() {
 		for (auto& s : m_systems)
 		{
 			if (s->m_enabled) {
+				const uint64_t start = Profiler::Now();
 				try {
+					PROFILE_ZONE(s->m_fixedUpdateZone);
 					s->fixedUpdate(*this);
 				}
-				catch (const std::runtime_error& e) {
-					Debug::logError(e.what());
+				catch (const std::runtime_error& e) {
+					Debug::logError(e.what());
 				}
+				s->m_fixedUpdateTiming.record(Profiler::TicksToMs(Profiler::Now() - start));
 			}
 		}
+		flushCommands();
 	}
 
 	void Scene::destroySystems() {
@@ -110,6 +416,87 @@ namespace engine {
 		}
 	}
 
+	void Scene::onTransformConstructed(entt::registry& registry, entt::entity entity) {
+		// Also for replaced ones, copied in transforms (snapshots, prefabs, replace) carry another
+		// entity's binding or none and may have the changed flag cleared
+		markTransformChanged(entity, registry.get<Transform2D>(entity));
+	}
+
+	void Scene::onTransformDestroyed(entt::registry& registry, entt::entity entity) {
+		m_pendingRemovedTransforms.push_back(entity);
+	}
+
+	void Scene::onInactiveConstructed(entt::registry& registry, entt::entity entity) {
+		m_spatialIndex.remove(entity);
+	}
+
+	void Scene::onInactiveDestroyed(entt::registry& registry, entt::entity entity) {
+		// Reinserted into the spatial index by the next refresh. The physics pass skips parked
+		// entities, a teleport it dropped meanwhile is handed to it again.
+		if (Transform2D* transform = registry.try_get<Transform2D>(entity)) {
+			markTransformChanged(entity, *transform);
+			if (transform->m_flags & Transform2D::k_teleport)
+				TransformChangeList::recordTeleport(m_transformChanges, transform->m_entity);
+		}
+	}
+
+	void Scene::markTransformChanged(entt::entity entity, Transform2D& transform) {
+		// A pending teleport set before the transform was bound here was recorded nowhere
+		const bool rebound = transform.m_changeList != m_transformChanges || transform.m_entity != static_cast<uint32_t>(entity);
+		transform.m_changeList = m_transformChanges;
+		transform.m_entity = static_cast<uint32_t>(entity);
+		transform.m_flags |= Transform2D::k_changed;
+		TransformChangeList::record(m_transformChanges, transform.m_entity);
+		if (rebound && (transform.m_flags & Transform2D::k_teleport))
+			TransformChangeList::recordTeleport(m_transformChanges, transform.m_entity);
+	}
+
+	void Scene::refreshTransforms() {
+		PROFILE_ZONE("Scene::RefreshTransforms");
+		m_changedTransforms.clear();
+		m_staleTransforms.clear();
+		m_transformBatch.clear();
+
+		// Only what was written since the last refresh, not every transform. Propagated children
+		// are recorded again and appended, so they land in this frame's changed list.
+		TransformChangeList::take(m_transformChanges, m_recordedTransforms);
+		propagateHierarchy(m_recordedTransforms);
+		TransformChangeList::take(m_transformChanges, m_propagatedTransforms);
+		m_recordedTransforms.insert(m_recordedTransforms.end(), m_propagatedTransforms.begin(), m_propagatedTransforms.end());
+		PROFILE_ZONE_ITEMS(m_recordedTransforms.size());
+		for (uint32_t id : m_recordedTransforms) {
+			const entt::entity entity = static_cast<entt::entity>(id);
+			if (!m_registry.valid(entity)) continue;
+			Transform2D* transform = m_registry.try_get<Transform2D>(entity);
+			// Recorded twice, or written through a copy of the component
+			if (transform == nullptr || !(transform->m_flags & Transform2D::k_changed)) continue;
+			transform->m_flags &= ~Transform2D::k_changed;
+			m_changedTransforms.push_back(entity);
+
+			if (transform->m_flags & Transform2D::k_cacheDirty) {
+				m_transformBatch.push(*transform);
+				m_staleTransforms.push_back(transform);
+			}
+		}
+
+		m_transformBatch.compute();
+		const auto& models = m_transformBatch.models();
+		const auto& bounds = m_transformBatch.bounds();
+		for (size_t i = 0; i < m_staleTransforms.size(); ++i)
+			m_staleTransforms[i]->setCache(models[i], bounds[i].min, bounds[i].max);
+
+		m_removedTransforms.swap(m_pendingRemovedTransforms);
+		m_pendingRemovedTransforms.clear();
+
+		// Removals first, a recycled id can be in both lists
+		for (entt::entity entity : m_removedTransforms)
+			m_spatialIndex.remove(entity);
+		for (entt::entity entity : m_changedTransforms) {
+			if (m_registry.all_of<Inactive>(entity)) continue;
+			m_spatialIndex.update(entity, graphics::AABB::create(m_registry.get<Transform2D>(entity)));
+		}
+	}
+
 	Box2DWorld& Scene::physicsWorld() { return s_physicsWorld; }
 
 	//entity handling
@@ -16,8 +16,16 @@
 #include <type_traits>
 #include <fstream>
 #include <stdexcept>
+#include <chrono>
 #include "Utils/Debug.h"
 #include "Physics/CollisionDispatcher.h"
+#include "TransformBatch.h"
+#include "Hierarchy.h"
+#include "Inactive.h"
+#include "SpatialHash.h"
+#include "CommandBuffer.h"
+#include <mutex>
+#include <thread>
 
 namespace engine {
 	class ISystem;
@@ -56,6 +64,32 @@ namespace engine {
 		void destroyEntity(entt::entity handle);
 
 		bool isValid(entt::entity handle) const;
+
+		// Buffer of the calling thread for structural changes that must not happen right away,
+		// e.g. while iterating a view or from a job. Fetch it once per job, recording is lock-free.
+		// Applied after fixedUpdate and update of all systems, or by flushCommands().
+		CommandBuffer& commands();
+		// Main thread only, with no job still recording
+		void flushCommands();
+#pragma endregion
+
+#pragma region HIERARCHY
+		// Attaches child to parent, entt::null detaches it. With keepWorldTransform the child stays
+		// where it is, otherwise its current transform becomes the local one. Both entities need
+		// a Transform2D, a Hierarchy is added where missing.
+		void setParent(entt::entity child, entt::entity parent, bool keepWorldTransform = true);
+		entt::entity getParent(entt::entity handle) const;
+
+		template<typename Fn>
+		void forEachChild(entt::entity handle, Fn&& fn) {
+			const Hierarchy* node = m_registry.try_get<Hierarchy>(handle);
+			for (entt::entity child = node ? node->firstChild : entt::null; child != entt::null;) {
+				// Read the link first so fn may detach the child
+				const entt::entity next = m_registry.get<Hierarchy>(child).nextSibling;
+				fn(child);
+				child = next;
+			}
+		}
 #pragma endregion
 
 #pragma region COMPONENT
@@ -180,6 +214,7 @@ namespace engine {
 			static_assert(std::is_base_of<ISystem, T>::value, "T must derive from ISystem");
 			auto sys = std::make_unique<T>(std::forward<Args>(args)...);
 			T& ref = *sys;
+			registerSystem(ref);
 			ref.awake(*this);
 			ref.start(*this);
 			m_systems.push_back(std::move(sys));
@@ -241,17 +276,60 @@ namespace engine {
 		entt::registry& registry();
 		const std::string& name() const;
 		bool isLoaded() const;
+		const std::vector<std::unique_ptr<ISystem>>& systems() const { return m_systems; }
+
+		// Entities whose Transform2D was created or written before the last refreshTransforms(),
+		// rebuilt once per frame after the systems updated. An entity destroyed and recreated
+		// in between shows up in both lists, handle removedTransforms() first.
+		const std::vector<entt::entity>& changedTransforms() const { return m_changedTransforms; }
+		const std::vector<entt::entity>& removedTransforms() const { return m_removedTransforms; }
+		// Entities whose transform was set by game code since the last call, the physics pass moves
+		// their bodies. Unlike the lists above it is drained on demand, several steps can run per frame.
+		void takeTeleportedTransforms(std::vector<uint32_t>& out) { TransformChangeList::takeTeleports(m_transformChanges, out); }
+		// Bounds of every active Transform2D entity, updated from the lists above in refreshTransforms()
+		SpatialHash& spatialIndex() { return m_spatialIndex; }
+
+		// Active sprites with a transform, set up with the scene. The group owns SpriteRenderer and
+		// keeps it packed in iteration order. Transform2D is only observed, a type can belong to one
+		// owning group and cameras hold pointers into its storage that reordering would break.
+		static auto renderGroup(entt::registry& registry) {
+			return registry.group<graphics::SpriteRenderer>(entt::get<Transform2D>, entt::exclude<Inactive>);
+		}
+		auto renderGroup() { return renderGroup(m_registry); }
+		// Sprites the render system drew from this scene last frame, picks how it collects the next one
+		size_t visibleSprites() const { return m_visibleSprites; }
+		void setVisibleSprites(size_t count) { m_visibleSprites = count; }
 
 	private:
+		void registerSystem(ISystem& system);
+		void publishSystemTimings();
 		void awakeSystems();
 		void startSystems();
 		void updateSystems();
 		void fixedUpdateSystems();
 		void destroySystems();
+		// Collects the changed transforms and refreshes their cached matrices in one batch
+		void refreshTransforms();
+		// Rebuilds world transforms below the recorded nodes, only where the parent or the
+		// local transform changed
+		void propagateHierarchy(const std::vector<uint32_t>& recorded);
+		// False when the node is clean and its parent did not change since the last rebuild
+		bool rebuildFromParent(entt::entity entity, Hierarchy& node);
+		void unlinkFromParent(Hierarchy& node);
+		void updateDepths(entt::entity root, uint32_t depth);
+		void onHierarchyConstructed(entt::registry& registry, entt::entity entity);
+		void onHierarchyDestroyed(entt::registry& registry, entt::entity entity);
+		void onTransformConstructed(entt::registry& registry, entt::entity entity);
+		void onTransformDestroyed(entt::registry& registry, entt::entity entity);
+		// Binds the transform to this scene's change list and records it
+		void markTransformChanged(entt::entity entity, Transform2D& transform);
+		void onInactiveConstructed(entt::registry& registry, entt::entity entity);
+		void onInactiveDestroyed(entt::registry& registry, entt::entity entity);
 		void instantiateSystemsFromFactories() {
 			m_systems.clear();
 			for (auto& factory : m_systemFactories) {
 				m_systems.push_back(factory());
+				registerSystem(*m_systems.back());
 			}
 		}
 
@@ -260,6 +338,23 @@ namespace engine {
 		std::vector<std::function<std::unique_ptr<ISystem>()>> m_systemFactories;
 		std::vector<std::unique_ptr<ISystem>> m_systems;
 		const std::string k_sceneName;
+		std::chrono::steady_clock::time_point m_timingWindowStart = std::chrono::steady_clock::now();
+
+		uint32_t m_transformChanges = TransformChangeList::open();
+		std::vector<uint32_t> m_recordedTransforms;
+		std::vector<entt::entity> m_changedTransforms;
+		std::vector<entt::entity> m_removedTransforms;
+		std::vector<entt::entity> m_pendingRemovedTransforms;
+		std::vector<const Transform2D*> m_staleTransforms;
+		TransformBatch m_transformBatch;
+		SpatialHash m_spatialIndex;
+		size_t m_visibleSprites = 0;
+		std::vector<uint32_t> m_propagatedTransforms;
+		std::vector<std::pair<uint32_t, entt::entity>> m_hierarchySeeds;   // (depth, entity)
+		std::vector<entt::entity> m_hierarchyOpen;
+
+		std::mutex m_commandMutex;
+		std::vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> m_commandBuffers;
 
 		bool m_loaded = false;
 		friend class SceneManager;
@@ -67,6 +67,9 @@ namespace engine {
 		Scene& scene = **it;
 		scene.m_systems.clear();
 		scene.m_registry.clear();
+		// Recorded against the old entities
+		for (auto& [id, buffer] : scene.m_commandBuffers)
+			buffer->clear();
 		scene.instantiateSystemsFromFactories();
 
 
@@ -93,6 +96,7 @@ namespace engine {
 		(*it)->m_loaded = false;
 		(*it)->destroySystems();
 		(*it)->m_registry.clear();
+		Profiler::Get().RemoveSystemTimings(name);
 
 		loadedScenes.erase(it);
 
@@ -130,6 +134,8 @@ namespace engine {
 			if (scene->isLoaded())
 			{
 				scene->updateSystems();
+				// After the systems, so rendering sees fresh matrices and this frame's changes
+				scene->refreshTransforms();
 			}
 		}
 	}
@@ -0,0 +1,282 @@
+#include "SceneSnapshot.h"
+#include "ComponentReflect.h"
+#include "Core/Scene.h"
+#include "Core/Profiler.h"
+#include "Utils/Debug.h"
+#include <lz4.h>
+#include <cstdio>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace engine {
+	namespace {
+		using EntityValue = entt::entt_traits<entt::entity>::entity_type;
+
+		struct OutputArchive {
+			std::vector<char>& out;
+
+			void operator()(EntityValue value) { write(&value, sizeof(value)); }
+			void operator()(entt::entity entity) { write(&entity, sizeof(entity)); }
+
+			void write(const void* data, size_t size) {
+				const size_t offset = out.size();
+				out.resize(offset + size);
+				std::memcpy(out.data() + offset, data, size);
+			}
+		};
+
+		struct InputArchive {
+			const char* cursor;
+			const char* end;
+
+			void operator()(EntityValue& value) { read(&value, sizeof(value)); }
+			void operator()(entt::entity& entity) { read(&entity, sizeof(entity)); }
+
+			void read(void* data, size_t size) {
+				if (static_cast<size_t>(end - cursor) < size)
+					throw std::runtime_error("Scene snapshot: entity block is truncated");
+				std::memcpy(data, cursor, size);
+				cursor += size;
+			}
+		};
+
+		template<typename T>
+		T readPod(const char*& cursor, const char* end) {
+			if (static_cast<size_t>(end - cursor) < sizeof(T))
+				throw std::runtime_error("Scene snapshot: unexpected end of data");
+			T value;
+			std::memcpy(&value, cursor, sizeof(T));
+			cursor += sizeof(T);
+			return value;
+		}
+	}
+
+	void SceneSnapshot::writeBlock(std::vector<char>& out, BlockHeader header, const char* raw, bool compress) {
+		const size_t headerOffset = out.size();
+		out.resize(headerOffset + sizeof(BlockHeader));
+		header.storedSize = header.rawSize;
+
+		if (compress && header.rawSize > 0 && header.rawSize <= static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE)) {
+			const int bound = LZ4_compressBound(static_cast<int>(header.rawSize));
+			const size_t payloadOffset = out.size();
+			out.resize(payloadOffset + bound);
+			const int written = LZ4_compress_default(raw, out.data() + payloadOffset, static_cast<int>(header.rawSize), bound);
+
+			// Only keep the compressed payload if it actually saves space
+			if (written > 0 && static_cast<uint64_t>(written) < header.rawSize) {
+				out.resize(payloadOffset + written);
+				header.storedSize = static_cast<uint64_t>(written);
+			}
+			else {
+				out.resize(payloadOffset);
+			}
+		}
+
+		if (header.storedSize == header.rawSize) {
+			const size_t payloadOffset = out.size();
+			out.resize(payloadOffset + header.rawSize);
+			if (header.rawSize > 0)
+				std::memcpy(out.data() + payloadOffset, raw, header.rawSize);
+		}
+
+		std::memcpy(out.data() + headerOffset, &header, sizeof(BlockHeader));
+	}
+
+	size_t SceneSnapshot::Capture::byteSize() const {
+		size_t size = 0;
+		for (const Block& block : blocks)
+			size += block.data.size();
+		return size;
+	}
+
+	SceneSnapshot::Capture SceneSnapshot::captureBlocks(const entt::registry& registry) {
+		PROFILE_ZONE("SceneSnapshot::Capture");
+		const std::vector<ComponentSchema>& schemas = ComponentReflect::schemas();
+
+		Capture capture;
+		capture.blocks.reserve(schemas.size() + 1);
+
+		// Entities including the free list, so entity versions survive the round trip
+		{
+			Capture::Block& block = capture.blocks.emplace_back(Capture::Block{ k_entityBlock, k_formatVersion, sizeof(EntityValue), 0, 0, {} });
+			OutputArchive archive{ block.data };
+			entt::snapshot{ registry }.get<entt::entity>(archive);
+		}
+
+		for (const ComponentSchema& schema : schemas) {
+			Capture::Block block{ schema.id, schema.version, schema.size, 0, schema.layoutHash, {} };
+			block.count = schema.save(registry, block.data);
+			if (block.count > 0)
+				capture.blocks.push_back(std::move(block));
+		}
+		PROFILE_ZONE_ITEMS(static_cast<uint32_t>(capture.byteSize()));
+		return capture;
+	}
+
+	std::vector<char> SceneSnapshot::encode(const Capture& capture, bool compress, std::atomic<float>* progress) {
+		PROFILE_ZONE("SceneSnapshot::Encode");
+		std::vector<char> out;
+		out.reserve(sizeof(FileHeader) + capture.byteSize() / (compress ? 2 : 1));
+
+		const FileHeader fileHeader{ k_magic, k_formatVersion, compress ? 1u : 0u, static_cast<uint32_t>(capture.blocks.size()) };
+		out.resize(sizeof(FileHeader));
+		std::memcpy(out.data(), &fileHeader, sizeof(FileHeader));
+
+		const size_t total = std::max<size_t>(capture.byteSize(), 1);
+		size_t done = 0;
+		for (const Capture::Block& block : capture.blocks) {
+			BlockHeader header{ block.typeId, block.version, block.elementSize, block.count, block.layoutHash, block.data.size(), 0 };
+			writeBlock(out, header, block.data.data(), compress);
+
+			done += block.data.size();
+			if (progress)
+				progress->store(static_cast<float>(done) / static_cast<float>(total), std::memory_order_relaxed);
+		}
+		return out;
+	}
+
+	std::vector<char> SceneSnapshot::capture(const entt::registry& registry, bool compress) {
+		return encode(captureBlocks(registry), compress);
+	}
+
+	void SceneSnapshot::restore(entt::registry& registry, const char* data, size_t size) {
+		PROFILE_ZONE("SceneSnapshot::Restore");
+		const char* cursor = data;
+		const char* end = data + size;
+
+		const FileHeader fileHeader = readPod<FileHeader>(cursor, end);
+		if (fileHeader.magic != k_magic)
+			throw std::runtime_error("Scene snapshot: invalid file");
+		if (fileHeader.formatVersion > k_formatVersion)
+			throw std::runtime_error("Scene snapshot: format version " + std::to_string(fileHeader.formatVersion) + " is newer than supported");
+
+		std::vector<char> raw;
+		std::vector<char> migrated;
+		for (uint32_t block = 0; block < fileHeader.blockCount; ++block) {
+			const BlockHeader header = readPod<BlockHeader>(cursor, end);
+			if (static_cast<uint64_t>(end - cursor) < header.storedSize)
+				throw std::runtime_error("Scene snapshot: block is truncated");
+
+			const char* payload = cursor;
+			cursor += header.storedSize;
+
+			const ComponentSchema* schema = nullptr;
+			if (header.typeId != k_entityBlock) {
+				schema = ComponentReflect::find(header.typeId);
+				if (schema == nullptr) {
+					Debug::logWarning("Scene snapshot: skipping unknown component type " + std::to_string(header.typeId));
+					continue;
+				}
+				if (header.version > schema->version) {
+					Debug::logWarning("Scene snapshot: skipping " + schema->name + ", saved with newer version " + std::to_string(header.version));
+					continue;
+				}
+				if (header.version < schema->version && !schema->migrate) {
+					Debug::logWarning("Scene snapshot: skipping " + schema->name + " version " + std::to_string(header.version) + ", no migration registered");
+					continue;
+				}
+				if (header.version == schema->version && header.layoutHash != schema->layoutHash) {
+					Debug::logWarning("Scene snapshot: skipping " + schema->name + ", layout changed without a version bump");
+					continue;
+				}
+			}
+
+			const char* blockData = payload;
+			if (header.storedSize != header.rawSize) {
+				raw.resize(header.rawSize);
+				const int decoded = LZ4_decompress_safe(payload, raw.data(), static_cast<int>(header.storedSize), static_cast<int>(header.rawSize));
+				if (decoded < 0 || static_cast<uint64_t>(decoded) != header.rawSize)
+					throw std::runtime_error("Scene snapshot: corrupt compressed block");
+				blockData = raw.data();
+			}
+
+			if (header.typeId == k_entityBlock) {
+				InputArchive archive{ blockData, blockData + header.rawSize };
+				entt::snapshot_loader{ registry }.get<entt::entity>(archive);
+				continue;
+			}
+
+			const uint64_t entityBytes = static_cast<uint64_t>(header.count) * sizeof(entt::entity);
+			if (entityBytes + static_cast<uint64_t>(header.count) * header.elementSize != header.rawSize)
+				throw std::runtime_error("Scene snapshot: size mismatch in block " + schema->name);
+
+			// Entities are byte aligned inside the block as well
+			std::vector<entt::entity> entities(header.count);
+			std::memcpy(entities.data(), blockData, entityBytes);
+			const char* componentData = blockData + entityBytes;
+
+			if (header.version < schema->version) {
+				if (!schema->migrate(componentData, header.count, header.version, header.elementSize, migrated)) {
+					Debug::logWarning("Scene snapshot: migration of " + schema->name + " from version " + std::to_string(header.version) + " failed");
+					continue;
+				}
+				componentData = migrated.data();
+			}
+
+			schema->load(registry, entities.data(), entities.size(), componentData);
+		}
+	}
+
+	void SceneSnapshot::save(Scene& scene, const std::filesystem::path& path, bool compress) {
+		writeFile(path, capture(scene.registry(), compress));
+	}
+
+	void SceneSnapshot::writeFile(const std::filesystem::path& path, const std::vector<char>& data) {
+		PROFILE_ZONE("SceneSnapshot::Write");
+		std::filesystem::path temporary = path;
+		temporary += ".tmp";
+
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, temporary.c_str(), L"wb") != 0) file = nullptr;
+#else
+		file = std::fopen(temporary.c_str(), "wb");
+#endif
+		if (!file)
+			throw std::runtime_error("Scene snapshot: could not open " + temporary.string() + " for writing");
+
+		bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+		ok = ok && std::fflush(file) == 0;
+#ifdef _MSC_VER
+		ok = ok && _commit(_fileno(file)) == 0;
+#else
+		ok = ok && fsync(fileno(file)) == 0;
+#endif
+		ok = std::fclose(file) == 0 && ok;
+		if (!ok) {
+			std::error_code ignored;
+			std::filesystem::remove(temporary, ignored);
+			throw std::runtime_error("Scene snapshot: could not write " + temporary.string());
+		}
+
+		std::filesystem::rename(temporary, path);
+	}
+
+	void SceneSnapshot::load(Scene& scene, const std::filesystem::path& path) {
+		FILE* file = nullptr;
+#ifdef _MSC_VER
+		if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+		file = std::fopen(path.c_str(), "rb");
+#endif
+		if (!file)
+			throw std::runtime_error("Scene snapshot: could not open " + path.string());
+
+		std::vector<char> data(static_cast<size_t>(std::filesystem::file_size(path)));
+		const size_t read = std::fread(data.data(), 1, data.size(), file);
+		std::fclose(file);
+		if (read != data.size())
+			throw std::runtime_error("Scene snapshot: could not read " + path.string());
+
+		entt::registry& registry = scene.registry();
+		registry.clear();
+		restore(registry, data.data(), data.size());
+	}
+}
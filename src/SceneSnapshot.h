@@ -0,0 +1,78 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace engine {
+	class Scene;
+
+	// Binary scene snapshot. Entities are written through entt's snapshot API, every component
+	// type registered in ComponentReflect is written as one contiguous block:
+	//
+	//   Header      magic "ESNP", format version, flags, block count
+	//   Block       type id, schema version, element size, count, layout hash, raw size, stored size
+	//   Payload     count entities followed by count components, LZ4 compressed if that is smaller
+	//
+	// Unknown component types and newer schema versions are skipped on load, older versions are
+	// converted through the migration passed to ComponentReflect::registerComponent.
+	class SceneSnapshot {
+	public:
+		static constexpr uint32_t k_magic = 0x504E5345; // "ESNP"
+		static constexpr uint32_t k_formatVersion = 1;
+
+		// Uncompressed copy of the packed storages, owns its memory so it can be encoded on another thread
+		struct Capture {
+			struct Block {
+				uint32_t typeId;
+				uint32_t version;
+				uint32_t elementSize;
+				uint32_t count;
+				uint64_t layoutHash;
+				std::vector<char> data;
+			};
+			std::vector<Block> blocks;
+
+			size_t byteSize() const;
+		};
+
+		// Has to run on the thread owning the registry, the rest of the pipeline does not touch it
+		static Capture captureBlocks(const entt::registry& registry);
+		// Lays out and compresses a capture, progress goes from 0 to 1 block by block
+		static std::vector<char> encode(const Capture& capture, bool compress = true, std::atomic<float>* progress = nullptr);
+		static std::vector<char> capture(const entt::registry& registry, bool compress = true);
+		// The registry has to be empty
+		static void restore(entt::registry& registry, const char* data, size_t size);
+
+		static void save(Scene& scene, const std::filesystem::path& path, bool compress = true);
+		// Clears the scene registry before restoring
+		static void load(Scene& scene, const std::filesystem::path& path);
+
+		// Writes to a temporary file, flushes it to disk and renames it over path, so a crash
+		// while saving never leaves a half written save behind
+		static void writeFile(const std::filesystem::path& path, const std::vector<char>& data);
+
+	private:
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t formatVersion;
+			uint32_t flags;
+			uint32_t blockCount;
+		};
+
+		struct BlockHeader {
+			uint32_t typeId;
+			uint32_t version;
+			uint32_t elementSize;
+			uint32_t count;
+			uint64_t layoutHash;
+			uint64_t rawSize;
+			uint64_t storedSize;
+		};
+
+		static constexpr uint32_t k_entityBlock = 0;
+
+		static void writeBlock(std::vector<char>& out, BlockHeader header, const char* raw, bool compress);
+	};
+}
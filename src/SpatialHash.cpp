@@ -0,0 +1,197 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace engine {
+	SpatialHash::SpatialHash(float cellSize)
+		: m_cellSize{ cellSize }, m_inverseCellSize{ 1.f / cellSize } {}
+
+	SpatialHash::CellRange SpatialHash::cellRange(const graphics::AABB& bounds) const {
+		return {
+			static_cast<int32_t>(std::floor(bounds.min.x * m_inverseCellSize)),
+			static_cast<int32_t>(std::floor(bounds.min.y * m_inverseCellSize)),
+			static_cast<int32_t>(std::floor(bounds.max.x * m_inverseCellSize)),
+			static_cast<int32_t>(std::floor(bounds.max.y * m_inverseCellSize))
+		};
+	}
+
+	SpatialHash::Entry* SpatialHash::find(entt::entity entity) {
+		const auto index = static_cast<size_t>(entt::to_entity(entity));
+		if (index >= m_entries.size() || m_entries[index].entity != entity) return nullptr;
+		return &m_entries[index];
+	}
+
+	bool SpatialHash::contains(entt::entity entity) const {
+		const auto index = static_cast<size_t>(entt::to_entity(entity));
+		return index < m_entries.size() && m_entries[index].entity == entity;
+	}
+
+	void SpatialHash::link(Entry& entry) {
+		const CellRange& r = entry.cells;
+		const int64_t cellCount = (static_cast<int64_t>(r.maxX) - r.minX + 1) * (static_cast<int64_t>(r.maxY) - r.minY + 1);
+		entry.oversized = cellCount > k_maxCellsPerEntry;
+		if (entry.oversized) {
+			m_oversized.push_back(entry.entity);
+			return;
+		}
+		for (int32_t y = r.minY; y <= r.maxY; ++y)
+			for (int32_t x = r.minX; x <= r.maxX; ++x)
+				m_cells[cellKey(x, y)].push_back(entry.entity);
+
+		if (m_occupied.maxX < m_occupied.minX) {
+			m_occupied = r;
+		}
+		else {
+			m_occupied.minX = std::min(m_occupied.minX, r.minX);
+			m_occupied.minY = std::min(m_occupied.minY, r.minY);
+			m_occupied.maxX = std::max(m_occupied.maxX, r.maxX);
+			m_occupied.maxY = std::max(m_occupied.maxY, r.maxY);
+		}
+	}
+
+	void SpatialHash::unlink(const Entry& entry) {
+		auto erase = [&](std::vector<entt::entity>& list) {
+			auto it = std::find(list.begin(), list.end(), entry.entity);
+			if (it == list.end()) return;
+			*it = list.back();
+			list.pop_back();
+		};
+
+		if (entry.oversized) {
+			erase(m_oversized);
+			return;
+		}
+		const CellRange& r = entry.cells;
+		for (int32_t y = r.minY; y <= r.maxY; ++y) {
+			for (int32_t x = r.minX; x <= r.maxX; ++x) {
+				auto it = m_cells.find(cellKey(x, y));
+				if (it == m_cells.end()) continue;
+				erase(it->second);
+				if (it->second.empty()) m_cells.erase(it);
+			}
+		}
+	}
+
+	void SpatialHash::update(entt::entity entity, const graphics::AABB& bounds) {
+		const auto index = static_cast<size_t>(entt::to_entity(entity));
+		if (index >= m_entries.size())
+			m_entries.resize(index + 1);
+		Entry& entry = m_entries[index];
+
+		// A different version in the slot is a destroyed entity that was never removed
+		if (entry.entity != entity && entry.entity != entt::null) {
+			unlink(entry);
+			entry = Entry{};
+			--m_count;
+		}
+
+		const CellRange cells = cellRange(bounds);
+		if (entry.entity == entity) {
+			entry.bounds = bounds;
+			// Small moves stay inside the same cells, only the bounds change
+			if (cells == entry.cells) return;
+			unlink(entry);
+		}
+		else {
+			entry.entity = entity;
+			entry.bounds = bounds;
+			++m_count;
+		}
+		entry.cells = cells;
+		link(entry);
+	}
+
+	void SpatialHash::remove(entt::entity entity) {
+		Entry* entry = find(entity);
+		if (!entry) return;
+		unlink(*entry);
+		*entry = Entry{};
+		--m_count;
+	}
+
+	void SpatialHash::clear() {
+		m_entries.clear();
+		m_cells.clear();
+		m_oversized.clear();
+		m_occupied = {};
+		m_count = 0;
+	}
+
+	float SpatialHash::distanceSquared(const graphics::AABB& bounds, const glm::vec2& point) {
+		const float dx = std::max({ bounds.min.x - point.x, 0.f, point.x - bounds.max.x });
+		const float dy = std::max({ bounds.min.y - point.y, 0.f, point.y - bounds.max.y });
+		return dx * dx + dy * dy;
+	}
+
+	void SpatialHash::kNearest(const glm::vec2& point, size_t k, std::vector<std::pair<entt::entity, float>>& out, float maxDistance) {
+		out.clear();
+		if (k == 0 || m_count == 0) return;
+
+		if (++m_stamp == 0) {
+			for (Entry& entry : m_entries) entry.queryStamp = 0;
+			m_stamp = 1;
+		}
+		const float maxDistanceSquared = maxDistance < std::numeric_limits<float>::max() ? maxDistance * maxDistance : maxDistance;
+
+		// out holds squared distances while searching, sorted, at most k long
+		auto consider = [&](entt::entity entity) {
+			Entry& entry = m_entries[entt::to_entity(entity)];
+			if (entry.queryStamp == m_stamp) return;
+			entry.queryStamp = m_stamp;
+			const float d = distanceSquared(entry.bounds, point);
+			if (d > maxDistanceSquared || (out.size() == k && d >= out.back().second)) return;
+			auto position = std::upper_bound(out.begin(), out.end(), d, [](float value, const auto& item) { return value < item.second; });
+			out.insert(position, { entity, d });
+			if (out.size() > k) out.pop_back();
+		};
+		auto visitCell = [&](int32_t x, int32_t y) {
+			auto it = m_cells.find(cellKey(x, y));
+			if (it == m_cells.end()) return;
+			for (entt::entity entity : it->second) consider(entity);
+		};
+
+		for (entt::entity entity : m_oversized)
+			consider(entity);
+
+		// Rings of cells around the point. Everything not found yet lies outside the visited
+		// square, so once the k-th distance is below the distance to its edge the search is done.
+		const int32_t cx = static_cast<int32_t>(std::floor(point.x * m_inverseCellSize));
+		const int32_t cy = static_cast<int32_t>(std::floor(point.y * m_inverseCellSize));
+		// Rings are clipped to the occupied cells, a point far outside skips the empty ones
+		const CellRange& occupied = m_occupied;
+		const int32_t firstRing = std::max({ occupied.minX - cx, cx - occupied.maxX, occupied.minY - cy, cy - occupied.maxY, 0 });
+		const int32_t lastRing = occupied.maxX < occupied.minX ? -1
+			: std::max({ cx - occupied.minX, occupied.maxX - cx, cy - occupied.minY, occupied.maxY - cy, 0 });
+		auto row = [&](int32_t y, int32_t fromX, int32_t toX) {
+			if (y < occupied.minY || y > occupied.maxY) return;
+			for (int32_t x = std::max(fromX, occupied.minX); x <= std::min(toX, occupied.maxX); ++x) visitCell(x, y);
+		};
+		auto column = [&](int32_t x, int32_t fromY, int32_t toY) {
+			if (x < occupied.minX || x > occupied.maxX) return;
+			for (int32_t y = std::max(fromY, occupied.minY); y <= std::min(toY, occupied.maxY); ++y) visitCell(x, y);
+		};
+
+		for (int32_t ring = firstRing; ring <= lastRing; ++ring) {
+			if (ring == 0) {
+				visitCell(cx, cy);
+			}
+			else {
+				row(cy - ring, cx - ring, cx + ring);
+				row(cy + ring, cx - ring, cx + ring);
+				column(cx - ring, cy - ring + 1, cy + ring - 1);
+				column(cx + ring, cy - ring + 1, cy + ring - 1);
+			}
+
+			const float edge = std::min({
+				point.x - static_cast<float>(cx - ring) * m_cellSize,
+				static_cast<float>(cx + ring + 1) * m_cellSize - point.x,
+				point.y - static_cast<float>(cy - ring) * m_cellSize,
+				static_cast<float>(cy + ring + 1) * m_cellSize - point.y });
+			if (edge * edge > maxDistanceSquared) break;
+			if (out.size() == k && out.back().second <= edge * edge) break;
+		}
+
+		for (auto& item : out)
+			item.second = std::sqrt(item.second);
+	}
+}
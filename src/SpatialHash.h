@@ -0,0 +1,118 @@
+#pragma once
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Utils/AABB.h"
+
+namespace engine {
+	// Uniform grid over entity bounds, cells live in a hash map so the world can be unbounded.
+	// Entries are only touched when their bounds change, a query costs the cells it covers
+	// plus the entries found there. Entities spanning more than k_maxCellsPerEntry cells are
+	// kept in a separate list that every query checks, so huge objects do not flood the grid.
+	class SpatialHash {
+	public:
+		explicit SpatialHash(float cellSize = 8.f);
+
+		// Inserts or moves the entity
+		void update(entt::entity entity, const graphics::AABB& bounds);
+		void remove(entt::entity entity);
+		void clear();
+
+		bool contains(entt::entity entity) const;
+		size_t size() const { return m_count; }
+		float cellSize() const { return m_cellSize; }
+
+		// fn(entity, bounds) once for every entity whose bounds intersect the region
+		template<typename Fn>
+		void queryRect(const graphics::AABB& region, Fn&& fn);
+
+		template<typename Fn>
+		void queryCircle(const glm::vec2& center, float radius, Fn&& fn);
+
+		// Up to k entities closest to point (distance to their bounds, 0 inside), nearest first
+		void kNearest(const glm::vec2& point, size_t k, std::vector<std::pair<entt::entity, float>>& out,
+			float maxDistance = std::numeric_limits<float>::max());
+
+		static constexpr int k_maxCellsPerEntry = 64;
+
+	private:
+		struct CellRange {
+			int32_t minX = 0, minY = 0, maxX = -1, maxY = -1;
+			bool operator==(const CellRange&) const = default;
+		};
+		struct Entry {
+			entt::entity entity = entt::null;
+			graphics::AABB bounds{};
+			CellRange cells;
+			bool oversized = false;
+			uint32_t queryStamp = 0;
+		};
+
+		CellRange cellRange(const graphics::AABB& bounds) const;
+		static uint64_t cellKey(int32_t x, int32_t y) {
+			return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+		}
+		Entry* find(entt::entity entity);
+		void link(Entry& entry);
+		void unlink(const Entry& entry);
+		static float distanceSquared(const graphics::AABB& bounds, const glm::vec2& point);
+
+		float m_cellSize;
+		float m_inverseCellSize;
+		// Indexed by entity index, the full entity is compared to catch recycled ids
+		std::vector<Entry> m_entries;
+		std::unordered_map<uint64_t, std::vector<entt::entity>> m_cells;
+		std::vector<entt::entity> m_oversized;
+		CellRange m_occupied;   // Cells ever used, bounds the nearest search
+		size_t m_count = 0;
+		uint32_t m_stamp = 0;
+	};
+
+	template<typename Fn>
+	void SpatialHash::queryRect(const graphics::AABB& region, Fn&& fn) {
+		// Stamps make each entry report once even if it covers several cells
+		if (++m_stamp == 0) {
+			for (Entry& entry : m_entries) entry.queryStamp = 0;
+			m_stamp = 1;
+		}
+		auto visit = [&](entt::entity entity) {
+			Entry& entry = m_entries[entt::to_entity(entity)];
+			if (entry.queryStamp == m_stamp) return;
+			entry.queryStamp = m_stamp;
+			if (graphics::AABB::intersects(entry.bounds, region))
+				fn(entity, entry.bounds);
+		};
+
+		for (entt::entity entity : m_oversized)
+			visit(entity);
+
+		const CellRange range = cellRange(region);
+		const int64_t cellCount = (static_cast<int64_t>(range.maxX) - range.minX + 1) * (static_cast<int64_t>(range.maxY) - range.minY + 1);
+		if (cellCount > static_cast<int64_t>(m_cells.size())) {
+			// Region larger than the populated grid, walking the cells is cheaper
+			for (auto& [key, cell] : m_cells)
+				for (entt::entity entity : cell) visit(entity);
+			return;
+		}
+		for (int32_t y = range.minY; y <= range.maxY; ++y) {
+			for (int32_t x = range.minX; x <= range.maxX; ++x) {
+				auto it = m_cells.find(cellKey(x, y));
+				if (it == m_cells.end()) continue;
+				for (entt::entity entity : it->second) visit(entity);
+			}
+		}
+	}
+
+	template<typename Fn>
+	void SpatialHash::queryCircle(const glm::vec2& center, float radius, Fn&& fn) {
+		const graphics::AABB region = graphics::AABB::create(center, glm::vec2{ radius });
+		queryRect(region, [&](entt::entity entity, const graphics::AABB& bounds) {
+			if (distanceSquared(bounds, center) <= radius * radius)
+				fn(entity, bounds);
+		});
+	}
+}
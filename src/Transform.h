@@ -1,120 +1,212 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <box2d/box2d.h>
+#include <cmath>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 
 namespace engine {
+	// Entities whose transform was written since the last Scene::refreshTransforms(), one list
+	// per scene so the refresh only visits those. Transforms reach their list through a slot
+	// handle rather than a pointer, a copy that outlives its scene then records nowhere.
+	// Recording is thread-safe, it happens once per transform and frame.
+	class TransformChangeList {
+	public:
+		static uint32_t open();
+		static void close(uint32_t handle);
+		static void record(uint32_t handle, uint32_t entity);
+		// Moves the recorded entities into out, duplicates are possible
+		static void take(uint32_t handle, std::vector<uint32_t>& out);
+		// Same for transforms moved by game code, drained by the physics pass before each step
+		static void recordTeleport(uint32_t handle, uint32_t entity);
+		static void takeTeleports(uint32_t handle, std::vector<uint32_t>& out);
+	};
+
+	// Position, scale and rotation plus a cached model matrix, sin/cos and world AABB.
+	// All writes go through the setters, they bump version() and mark the transform as
+	// changed. The cache is refreshed in one batch by Scene::refreshTransforms() once per
+	// frame, reading mat3() or the bounds earlier recomputes it on the spot, which is not
+	// safe while other threads read the same transform.
 	struct Transform2D {
 		Transform2D() = default;
 
 		static Transform2D FromPosition(glm::vec2 position) {
 			Transform2D transform;
-			transform.position = position;
+			transform.setPosition(position);
 			return transform;
 		}
 		static Transform2D FromPositionRotation(glm::vec2 position, float degrees) {
 			Transform2D transform;
-			transform.position = position;
-			transform.rotation = glm::radians(degrees);
+			transform.setPosition(position);
+			transform.setRotation(degrees);
 			return transform;
 		}
 		static Transform2D FromPositionScaleRotation(glm::vec2 position, glm::vec2 scale, float degrees) {
 			Transform2D transform;
-			transform.position = position;
-			transform.scale = scale;
-			transform.rotation = glm::radians(degrees);;
+			transform.setPosition(position);
+			transform.setScale(scale);
+			transform.setRotation(degrees);
 			return transform;
 		}
 		static Transform2D FromPositionScale(glm::vec2 position, glm::vec2 scale) {
 			Transform2D transform;
-			transform.position = position;
-			transform.scale = scale;
+			transform.setPosition(position);
+			transform.setScale(scale);
 			return transform;
 		}
 
 		static Transform2D FromScale(glm::vec2 scale) {
 			Transform2D transform;
-			transform.scale = scale;
+			transform.setScale(scale);
 			return transform;
 		}
 		static Transform2D FromScaleRotation(glm::vec2 scale, float degrees) {
 			Transform2D transform;
-			transform.scale = scale;
-			transform.rotation = glm::radians(degrees);
+			transform.setScale(scale);
+			transform.setRotation(degrees);
 			return transform;
 		}
 
 		static Transform2D FromRotation(float degrees) {
 			Transform2D transform;
-			transform.rotation = glm::radians(degrees);
+			transform.setRotation(degrees);
 			return transform;
 		}
 
-		float getRotationDegrees() { return glm::degrees(rotation); }
-
-		glm::vec2 position{0.f};        // 2D position (X, Y)
-		glm::vec2 scale{ 1.f, 1.f };   // 2D scale (X, Y)
-		float rotation{0.f};            // Rotation angle in radians (around Z-axis)
-		bool dirtyPosOrRot{ false }, dirtyScale{ false };
+		const glm::vec2& position() const { return m_position; }   // 2D position (X, Y)
+		const glm::vec2& scale() const { return m_scale; }         // 2D scale (X, Y)
+		float rotation() const { return m_rotation; }               // Rotation angle in radians (around Z-axis)
+		float getRotationDegrees() const { return glm::degrees(m_rotation); }
+		float sinRotation() const { return m_sin; }
+		float cosRotation() const { return m_cos; }
 
 		void setPosition(const glm::vec2& p) {
-			position = p;
-			dirtyPosOrRot = true;
+			m_position = p;
+			markChanged(k_teleport);
 		}
+		void translate(const glm::vec2& delta) { setPosition(m_position + delta); }
 		void setScale(const glm::vec2& s) {
-			scale = s;
-			dirtyScale = true;
+			m_scale = s;
+			markChanged(k_teleport);
 		}
-		void setRotation(float degrees) {
-			rotation = glm::radians(degrees);
-			dirtyPosOrRot = true;
+		void setRotation(float degrees) { setRotationRadians(glm::radians(degrees)); }
+		void setRotationRadians(float radians) {
+			m_rotation = radians;
+			m_sin = std::sin(radians);
+			m_cos = std::cos(radians);
+			markChanged(k_teleport);
 		}
 
-		b2Rot b2Rotation() const {
-			return  b2Rot(std::cos(rotation), std::sin(rotation));
+		// All three at once, one version bump
+		void set(const glm::vec2& position, const glm::vec2& scale, float radians) {
+			m_position = position;
+			m_scale = scale;
+			m_rotation = radians;
+			m_sin = std::sin(radians);
+			m_cos = std::cos(radians);
+			markChanged(k_teleport);
 		}
 
-		glm::mat3 mat3() {
-			const float s = glm::sin(rotation);
-			const float c = glm::cos(rotation);
-
-			// Rotation matrix in 3x3 form:
-			glm::mat3 rotMatrix{
-				{ c,  s, 0.0f },
-				{ -s, c, 0.0f },
-				{ 0.0f, 0.0f, 1.0f }
-			};
-
-			// Scaling matrix in 3x3 form:
-			glm::mat3 scaleMat{
-				{ scale.x, 0.0f,   0.0f },
-				{ 0.0f,   scale.y, 0.0f },
-				{ 0.0f,   0.0f,    1.0f }
-			};
-
-			// Corrected Translation matrix in 3x3 form:
-			glm::mat3 transMat{
-				{ 1.0f, 0.0f, 0.0f },
-				{ 0.0f, 1.0f, 0.0f },
-				{ position.x, position.y, 1.0f }
-			};
+		b2Rot b2Rotation() const {
+			return b2Rot(m_cos, m_sin);
+		}
 
-			// Combine them: translation * rotation * scale
-			return transMat * rotMatrix * scaleMat;
+		// translation * rotation * scale
+		const glm::mat3& mat3() const {
+			if (m_flags & k_cacheDirty) updateCache();
+			return m_model;
+		}
+		const glm::vec2& boundsMin() const {
+			if (m_flags & k_cacheDirty) updateCache();
+			return m_boundsMin;
+		}
+		const glm::vec2& boundsMax() const {
+			if (m_flags & k_cacheDirty) updateCache();
+			return m_boundsMax;
 		}
 
-		std::string ToString(bool detailed = true) {
+		// Incremented on every write, lets consumers tell whether their copy is stale
+		uint32_t version() const { return m_version; }
+		// Written since the last Scene::refreshTransforms()
+		bool changed() const { return m_flags & k_changed; }
+
+		std::string ToString(bool detailed = true) const {
 			if (detailed)
 			{
 				return
-					"{ " + std::to_string(position.x) + ", " + std::to_string(position.y) + " }" + "\n" +
-					"{ " + std::to_string(scale.x) + ", " + std::to_string(scale.y) + " }" + "\n" + 
-					"{ " + std::to_string(rotation) + " }";
+					"{ " + std::to_string(m_position.x) + ", " + std::to_string(m_position.y) + " }" + "\n" +
+					"{ " + std::to_string(m_scale.x) + ", " + std::to_string(m_scale.y) + " }" + "\n" + 
+					"{ " + std::to_string(m_rotation) + " }";
 			}
 			else {
-				return 	"{ " + std::to_string(position.x) + ", " + std::to_string(position.y) + " }";
+				return 	"{ " + std::to_string(m_position.x) + ", " + std::to_string(m_position.y) + " }";
 			}
 		}
+
+	private:
+		static constexpr uint8_t k_changed = 1 << 0;      // Cleared by Scene::refreshTransforms()
+		static constexpr uint8_t k_cacheDirty = 1 << 1;   // Matrix and bounds are stale
+		static constexpr uint8_t k_teleport = 1 << 2;     // Set by game code, the physics body has to follow
+
+		void markChanged(uint8_t extra = 0) {
+			++m_version;
+			if (!(m_flags & k_changed))
+				TransformChangeList::record(m_changeList, m_entity);
+			if ((extra & k_teleport) && !(m_flags & k_teleport))
+				TransformChangeList::recordTeleport(m_changeList, m_entity);
+			m_flags |= k_changed | k_cacheDirty | extra;
+		}
+
+		// Written back by PhysicsSystem, the body already is where the transform says
+		void syncFromPhysics(const glm::vec2& position, b2Rot rotation) {
+			m_position = position;
+			m_rotation = b2Rot_GetAngle(rotation);
+			m_sin = rotation.s;
+			m_cos = rotation.c;
+			markChanged();
+		}
+
+		void updateCache() const {
+			m_model = glm::mat3{
+				{ m_cos * m_scale.x, m_sin * m_scale.x, 0.0f },
+				{ -m_sin * m_scale.y, m_cos * m_scale.y, 0.0f },
+				{ m_position.x, m_position.y, 1.0f }
+			};
+			// Half extents of the rotated box
+			const float hx = std::abs(m_scale.x) * 0.5f;
+			const float hy = std::abs(m_scale.y) * 0.5f;
+			const glm::vec2 extents{ std::abs(m_cos) * hx + std::abs(m_sin) * hy, std::abs(m_sin) * hx + std::abs(m_cos) * hy };
+			m_boundsMin = m_position - extents;
+			m_boundsMax = m_position + extents;
+			m_flags &= ~k_cacheDirty;
+		}
+
+		// Scene fills the cache from the batch kernel
+		void setCache(const glm::mat3& model, const glm::vec2& boundsMin, const glm::vec2& boundsMax) const {
+			m_model = model;
+			m_boundsMin = boundsMin;
+			m_boundsMax = boundsMax;
+			m_flags &= ~k_cacheDirty;
+		}
+
+		glm::vec2 m_position{ 0.f };
+		glm::vec2 m_scale{ 1.f, 1.f };
+		float m_rotation{ 0.f };
+		float m_sin{ 0.f };
+		float m_cos{ 1.f };
+		uint32_t m_version{ 0 };
+		// Bound by the owning scene when the component is constructed, 0 outside of a scene
+		uint32_t m_changeList{ 0 };
+		uint32_t m_entity{ 0 };
+
+		mutable glm::mat3 m_model{ 1.f };
+		mutable glm::vec2 m_boundsMin{ -0.5f };
+		mutable glm::vec2 m_boundsMax{ 0.5f };
+		mutable uint8_t m_flags{ k_changed };
+
+		friend class Scene;
+		friend class PhysicsSystem;
 	};
 }
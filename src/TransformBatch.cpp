@@ -0,0 +1,228 @@
+#include "TransformBatch.h"
+#include "CpuFeatures.h"
+#include <cmath>
+#include <cstdint>
+
+#if defined(ENGINE_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace engine {
+	namespace {
+		// Cody-Waite split of pi/2, the reduction stays exact for the first few thousand quadrants
+		constexpr float k_twoOverPi = 0.636619772367581f;
+		constexpr float k_halfPi1 = 1.5703125f;
+		constexpr float k_halfPi2 = 4.837512969970703125e-4f;
+		constexpr float k_halfPi3 = 7.54978995489188216e-8f;
+
+		// Minimax polynomials on [-pi/4, pi/4] (Cephes sinf/cosf)
+		constexpr float k_sin1 = -1.6666654611e-1f;
+		constexpr float k_sin2 = 8.3321608736e-3f;
+		constexpr float k_sin3 = -1.9515295891e-4f;
+		constexpr float k_cos1 = 4.166664568298827e-2f;
+		constexpr float k_cos2 = -1.388731625493765e-3f;
+		constexpr float k_cos3 = 2.443315711809948e-5f;
+
+		// Column major like glm: (c*sx, s*sx, 0), (-s*sy, c*sy, 0), (px, py, 1)
+		inline void writeModel(glm::mat3& m, float px, float py, float sx, float sy, float s, float c) {
+			m[0][0] = c * sx;  m[0][1] = s * sx;  m[0][2] = 0.f;
+			m[1][0] = -s * sy; m[1][1] = c * sy;  m[1][2] = 0.f;
+			m[2][0] = px;      m[2][1] = py;      m[2][2] = 1.f;
+		}
+
+#if defined(ENGINE_SIMD_X86)
+		// Both return how many elements they handled, the rest goes through the scalar tail
+		ENGINE_TARGET_AVX2 size_t computeAvx2(const float* positionX, const float* positionY, const float* scaleX, const float* scaleY,
+			const float* rotation, size_t count, glm::mat3* models, graphics::AABB* bounds) {
+			size_t i = 0;
+			const __m256 twoOverPi = _mm256_set1_ps(k_twoOverPi);
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 one = _mm256_set1_ps(1.f);
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			const __m256i oneI = _mm256_set1_epi32(1);
+			const __m256i twoI = _mm256_set1_epi32(2);
+
+			alignas(32) float s[8], c[8], ex[8], ey[8];
+			for (; i + 8 <= count; i += 8) {
+				const __m256 angle = _mm256_loadu_ps(rotation + i);
+				const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(angle, twoOverPi));
+				const __m256 q = _mm256_cvtepi32_ps(quadrant);
+				__m256 r = _mm256_sub_ps(angle, _mm256_mul_ps(q, _mm256_set1_ps(k_halfPi1)));
+				r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(k_halfPi2)));
+				r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(k_halfPi3)));
+				const __m256 r2 = _mm256_mul_ps(r, r);
+
+				__m256 ps = _mm256_add_ps(_mm256_set1_ps(k_sin2), _mm256_mul_ps(r2, _mm256_set1_ps(k_sin3)));
+				ps = _mm256_add_ps(_mm256_set1_ps(k_sin1), _mm256_mul_ps(r2, ps));
+				ps = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), ps));
+				__m256 pc = _mm256_add_ps(_mm256_set1_ps(k_cos2), _mm256_mul_ps(r2, _mm256_set1_ps(k_cos3)));
+				pc = _mm256_add_ps(_mm256_set1_ps(k_cos1), _mm256_mul_ps(r2, pc));
+				pc = _mm256_add_ps(_mm256_sub_ps(one, _mm256_mul_ps(half, r2)), _mm256_mul_ps(_mm256_mul_ps(r2, r2), pc));
+
+				// Odd quadrants swap sin and cos, bit 1 of q (q + 1 for cos) flips the sign
+				const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, oneI), oneI));
+				const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, twoI), 30));
+				const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, oneI), twoI), 30));
+				const __m256 sine = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sinSign);
+				const __m256 cosine = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cosSign);
+
+				const __m256 hx = _mm256_mul_ps(_mm256_loadu_ps(scaleX + i), half);
+				const __m256 hy = _mm256_mul_ps(_mm256_loadu_ps(scaleY + i), half);
+				const __m256 as = _mm256_and_ps(sine, absMask);
+				const __m256 ac = _mm256_and_ps(cosine, absMask);
+				// Half extents of the rotated box, same result as rotating the four corners
+				_mm256_store_ps(ex, _mm256_add_ps(_mm256_mul_ps(ac, _mm256_and_ps(hx, absMask)), _mm256_mul_ps(as, _mm256_and_ps(hy, absMask))));
+				_mm256_store_ps(ey, _mm256_add_ps(_mm256_mul_ps(as, _mm256_and_ps(hx, absMask)), _mm256_mul_ps(ac, _mm256_and_ps(hy, absMask))));
+				_mm256_store_ps(s, sine);
+				_mm256_store_ps(c, cosine);
+
+				for (int lane = 0; lane < 8; ++lane) {
+					const size_t index = i + lane;
+					if (bounds) {
+						bounds[index].min = { positionX[index] - ex[lane], positionY[index] - ey[lane] };
+						bounds[index].max = { positionX[index] + ex[lane], positionY[index] + ey[lane] };
+					}
+					if (models)
+						writeModel(models[index], positionX[index], positionY[index], scaleX[index], scaleY[index], s[lane], c[lane]);
+				}
+			}
+			return i;
+		}
+
+		size_t computeSse2(const float* positionX, const float* positionY, const float* scaleX, const float* scaleY,
+			const float* rotation, size_t count, glm::mat3* models, graphics::AABB* bounds) {
+			size_t i = 0;
+			// SSE2 has no blendv, selects go through and/andnot/or
+			const __m128 twoOverPi = _mm_set1_ps(k_twoOverPi);
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 one = _mm_set1_ps(1.f);
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			const __m128i oneI = _mm_set1_epi32(1);
+			const __m128i twoI = _mm_set1_epi32(2);
+			auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); };
+
+			alignas(16) float s[4], c[4], ex[4], ey[4];
+			for (; i + 4 <= count; i += 4) {
+				const __m128 angle = _mm_loadu_ps(rotation + i);
+				const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, twoOverPi));
+				const __m128 q = _mm_cvtepi32_ps(quadrant);
+				__m128 r = _mm_sub_ps(angle, _mm_mul_ps(q, _mm_set1_ps(k_halfPi1)));
+				r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(k_halfPi2)));
+				r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(k_halfPi3)));
+				const __m128 r2 = _mm_mul_ps(r, r);
+
+				__m128 ps = _mm_add_ps(_mm_set1_ps(k_sin2), _mm_mul_ps(r2, _mm_set1_ps(k_sin3)));
+				ps = _mm_add_ps(_mm_set1_ps(k_sin1), _mm_mul_ps(r2, ps));
+				ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+				__m128 pc = _mm_add_ps(_mm_set1_ps(k_cos2), _mm_mul_ps(r2, _mm_set1_ps(k_cos3)));
+				pc = _mm_add_ps(_mm_set1_ps(k_cos1), _mm_mul_ps(r2, pc));
+				pc = _mm_add_ps(_mm_sub_ps(one, _mm_mul_ps(half, r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+				const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, oneI), oneI));
+				const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, twoI), 30));
+				const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, oneI), twoI), 30));
+				const __m128 sine = _mm_xor_ps(select(swap, ps, pc), sinSign);
+				const __m128 cosine = _mm_xor_ps(select(swap, pc, ps), cosSign);
+
+				const __m128 hx = _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(scaleX + i), half), absMask);
+				const __m128 hy = _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(scaleY + i), half), absMask);
+				const __m128 as = _mm_and_ps(sine, absMask);
+				const __m128 ac = _mm_and_ps(cosine, absMask);
+				_mm_store_ps(ex, _mm_add_ps(_mm_mul_ps(ac, hx), _mm_mul_ps(as, hy)));
+				_mm_store_ps(ey, _mm_add_ps(_mm_mul_ps(as, hx), _mm_mul_ps(ac, hy)));
+				_mm_store_ps(s, sine);
+				_mm_store_ps(c, cosine);
+
+				for (int lane = 0; lane < 4; ++lane) {
+					const size_t index = i + lane;
+					if (bounds) {
+						bounds[index].min = { positionX[index] - ex[lane], positionY[index] - ey[lane] };
+						bounds[index].max = { positionX[index] + ex[lane], positionY[index] + ey[lane] };
+					}
+					if (models)
+						writeModel(models[index], positionX[index], positionY[index], scaleX[index], scaleY[index], s[lane], c[lane]);
+				}
+			}
+			return i;
+		}
+#endif
+	}
+
+	void fastSinCos(float radians, float& sine, float& cosine) {
+		const int32_t quadrant = static_cast<int32_t>(std::nearbyint(radians * k_twoOverPi));
+		const float q = static_cast<float>(quadrant);
+		const float r = ((radians - q * k_halfPi1) - q * k_halfPi2) - q * k_halfPi3;
+		const float r2 = r * r;
+
+		const float s = r + r * r2 * (k_sin1 + r2 * (k_sin2 + r2 * k_sin3));
+		const float c = 1.f - 0.5f * r2 + r2 * r2 * (k_cos1 + r2 * (k_cos2 + r2 * k_cos3));
+
+		switch (quadrant & 3) {
+		case 0: sine = s;  cosine = c;  break;
+		case 1: sine = c;  cosine = -s; break;
+		case 2: sine = -s; cosine = -c; break;
+		default: sine = -c; cosine = s; break;
+		}
+	}
+
+	void TransformBatch::clear() {
+		m_positionX.clear();
+		m_positionY.clear();
+		m_scaleX.clear();
+		m_scaleY.clear();
+		m_rotation.clear();
+	}
+
+	void TransformBatch::reserve(size_t count) {
+		m_positionX.reserve(count);
+		m_positionY.reserve(count);
+		m_scaleX.reserve(count);
+		m_scaleY.reserve(count);
+		m_rotation.reserve(count);
+	}
+
+	size_t TransformBatch::push(const Transform2D& transform) {
+		m_positionX.push_back(transform.position().x);
+		m_positionY.push_back(transform.position().y);
+		m_scaleX.push_back(transform.scale().x);
+		m_scaleY.push_back(transform.scale().y);
+		m_rotation.push_back(transform.rotation());
+		return m_positionX.size() - 1;
+	}
+
+	void TransformBatch::compute(bool models) {
+		const size_t count = size();
+		m_bounds.resize(count);
+		if (models) m_models.resize(count);
+		compute(m_positionX.data(), m_positionY.data(), m_scaleX.data(), m_scaleY.data(), m_rotation.data(), count,
+			models ? m_models.data() : nullptr, m_bounds.data());
+	}
+
+	void TransformBatch::compute(const float* positionX, const float* positionY, const float* scaleX, const float* scaleY,
+		const float* rotation, size_t count, glm::mat3* models, graphics::AABB* bounds) {
+		size_t i = 0;
+
+#if defined(ENGINE_SIMD_X86)
+		switch (CpuFeatures::simd()) {
+		case CpuFeatures::Simd::Avx2: i = computeAvx2(positionX, positionY, scaleX, scaleY, rotation, count, models, bounds); break;
+		case CpuFeatures::Simd::Sse2: i = computeSse2(positionX, positionY, scaleX, scaleY, rotation, count, models, bounds); break;
+		default: break;
+		}
+#endif
+
+		for (; i < count; ++i) {
+			float s, c;
+			fastSinCos(rotation[i], s, c);
+			const float hx = std::abs(scaleX[i] * 0.5f);
+			const float hy = std::abs(scaleY[i] * 0.5f);
+			const float ex = std::abs(c) * hx + std::abs(s) * hy;
+			const float ey = std::abs(s) * hx + std::abs(c) * hy;
+			if (bounds) {
+				bounds[i].min = { positionX[i] - ex, positionY[i] - ey };
+				bounds[i].max = { positionX[i] + ex, positionY[i] + ey };
+			}
+			if (models)
+				writeModel(models[i], positionX[i], positionY[i], scaleX[i], scaleY[i], s, c);
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "Components/Transform.h"
+#include "Utils/AABB.h"
+
+namespace engine {
+	// sin and cos in one go, max error about 1e-7 for |radians| up to a few thousand
+	void fastSinCos(float radians, float& sine, float& cosine);
+
+	// Model matrices and world AABBs for many transforms in one SIMD pass (AVX2 or SSE2,
+	// picked at runtime by CpuFeatures). Gather with push(), run compute(), read back by push index.
+	class TransformBatch {
+	public:
+		void clear();
+		void reserve(size_t count);
+		// Returns the index of the transform in models() and bounds()
+		size_t push(const Transform2D& transform);
+		size_t size() const { return m_positionX.size(); }
+
+		// With models = false only the bounds are written, enough for culling
+		void compute(bool models = true);
+
+		const std::vector<glm::mat3>& models() const { return m_models; }
+		const std::vector<graphics::AABB>& bounds() const { return m_bounds; }
+
+		// The kernel itself. Scale is the full size, the AABB uses half of it like AABB::create.
+		// models or bounds may be nullptr to skip them.
+		static void compute(const float* positionX, const float* positionY, const float* scaleX, const float* scaleY,
+			const float* rotation, size_t count, glm::mat3* models, graphics::AABB* bounds);
+
+	private:
+		std::vector<float> m_positionX, m_positionY;
+		std::vector<float> m_scaleX, m_scaleY;
+		std::vector<float> m_rotation;
+		std::vector<glm::mat3> m_models;
+		std::vector<graphics::AABB> m_bounds;
+	};
+}
@@ -0,0 +1,97 @@
+#include "Components/Transform.h"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace engine {
+	namespace {
+		// Handle = slot | generation << k_slotBits, closing a slot bumps its generation
+		constexpr uint32_t k_slotBits = 8;
+		constexpr uint32_t k_maxSlots = 1u << k_slotBits;
+		constexpr uint32_t k_generationMask = 0xFFFFFFFFu >> k_slotBits;
+
+		struct Slot {
+			std::atomic<uint32_t> generation{ 0 };
+			std::atomic_flag busy;
+			std::vector<uint32_t> entities;
+			std::vector<uint32_t> teleports;
+			bool used = false;
+
+			void lock() { while (busy.test_and_set(std::memory_order_acquire)) busy.wait(true, std::memory_order_relaxed); }
+			void unlock() { busy.clear(std::memory_order_release); busy.notify_one(); }
+		};
+
+		Slot s_slots[k_maxSlots];
+		std::mutex s_slotMutex;
+
+		Slot* slotOf(uint32_t handle) {
+			Slot& slot = s_slots[handle & (k_maxSlots - 1)];
+			return slot.generation.load(std::memory_order_acquire) == (handle >> k_slotBits) ? &slot : nullptr;
+		}
+	}
+
+	uint32_t TransformChangeList::open() {
+		std::lock_guard lock(s_slotMutex);
+		for (uint32_t i = 0; i < k_maxSlots; ++i) {
+			Slot& slot = s_slots[i];
+			if (slot.used) continue;
+			slot.used = true;
+			// Generation 0 is never handed out, a handle of 0 means no list
+			uint32_t generation = (slot.generation.load(std::memory_order_relaxed) + 1) & k_generationMask;
+			if (generation == 0) generation = 1;
+			slot.generation.store(generation, std::memory_order_release);
+			return i | (generation << k_slotBits);
+		}
+		throw std::runtime_error("Too many transform change lists, at most " + std::to_string(k_maxSlots) + " scenes can be loaded");
+	}
+
+	void TransformChangeList::close(uint32_t handle) {
+		std::lock_guard lock(s_slotMutex);
+		Slot* slot = slotOf(handle);
+		if (slot == nullptr) return;
+		slot->generation.fetch_add(1, std::memory_order_acq_rel);
+		slot->lock();
+		slot->entities.clear();
+		slot->entities.shrink_to_fit();
+		slot->teleports.clear();
+		slot->teleports.shrink_to_fit();
+		slot->unlock();
+		slot->used = false;
+	}
+
+	void TransformChangeList::record(uint32_t handle, uint32_t entity) {
+		if (handle == 0) return;
+		Slot* slot = slotOf(handle);
+		if (slot == nullptr) return;
+		slot->lock();
+		slot->entities.push_back(entity);
+		slot->unlock();
+	}
+
+	void TransformChangeList::take(uint32_t handle, std::vector<uint32_t>& out) {
+		out.clear();
+		Slot* slot = slotOf(handle);
+		if (slot == nullptr) return;
+		slot->lock();
+		out.swap(slot->entities);
+		slot->unlock();
+	}
+
+	void TransformChangeList::recordTeleport(uint32_t handle, uint32_t entity) {
+		if (handle == 0) return;
+		Slot* slot = slotOf(handle);
+		if (slot == nullptr) return;
+		slot->lock();
+		slot->teleports.push_back(entity);
+		slot->unlock();
+	}
+
+	void TransformChangeList::takeTeleports(uint32_t handle, std::vector<uint32_t>& out) {
+		out.clear();
+		Slot* slot = slotOf(handle);
+		if (slot == nullptr) return;
+		slot->lock();
+		out.swap(slot->teleports);
+		slot->unlock();
+	}
+}
@@ -109,7 +109,7 @@ namespace engine {
 	}
 
 	void Window::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-		engine::Input::s_scrollValue = static_cast<float>(yoffset);
+		engine::Input::onScroll(static_cast<float>(yoffset));
 	}
 
 	void Window::centerWindow() {
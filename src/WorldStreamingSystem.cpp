@@ -0,0 +1,51 @@
+#include "WorldStreamingSystem.h"
+#include "Graphics/Camera.h"
+#include "Core/Profiler.h"
+
+namespace engine {
+	WorldStreamingSystem::WorldStreamingSystem(uint32_t seed, std::filesystem::path cacheDirectory, int loadMargin, int unloadMargin)
+		: m_generator{ seed, std::move(cacheDirectory) }, m_loadMargin{ loadMargin }, m_unloadMargin{ std::max(unloadMargin, loadMargin) } {}
+
+	void WorldStreamingSystem::update(Scene& scene) {
+		graphics::Camera* camera = graphics::Camera::m_mainCamera;
+		if (camera == nullptr) return;
+		PROFILE_ZONE("World::Streaming");
+
+		const AABB view = camera->viewportAABB();
+		const ChunkCoord min = Chunk::coordOf(view.min);
+		const ChunkCoord max = Chunk::coordOf(view.max);
+		const glm::vec2 focus = camera->transform->position();
+
+		// Taken first, a chunk that finished since the last frame is not requested again
+		for (auto& finished : m_generator.takeFinished()) {
+			const ChunkCoord coord = finished->coord;
+			m_chunks[coord] = std::move(finished);
+		}
+
+		// Same square as the request loop below, so corner chunks are not dropped every frame
+		const float halfSpan = 0.5f * static_cast<float>(std::max(max.x - min.x, max.y - min.y) + 1);
+		m_generator.setFocus(focus, halfSpan + static_cast<float>(m_unloadMargin));
+
+		for (int y = min.y - m_loadMargin; y <= max.y + m_loadMargin; ++y) {
+			for (int x = min.x - m_loadMargin; x <= max.x + m_loadMargin; ++x) {
+				if (!m_chunks.contains({ x, y }))
+					m_generator.request({ x, y });
+			}
+		}
+		m_generator.pump();
+
+		std::erase_if(m_chunks, [&](const auto& entry) {
+			const ChunkCoord c = entry.first;
+			return c.x < min.x - m_unloadMargin || c.x > max.x + m_unloadMargin
+				|| c.y < min.y - m_unloadMargin || c.y > max.y + m_unloadMargin;
+		});
+
+		SET_GEN_STAT("Chunks loaded", m_chunks.size(), None);
+		SET_GEN_STAT("Chunks pending", m_generator.pendingCount() + m_generator.inFlightCount(), None);
+	}
+
+	const Chunk* WorldStreamingSystem::chunk(ChunkCoord coord) const {
+		auto it = m_chunks.find(coord);
+		return it != m_chunks.end() ? it->second.get() : nullptr;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Core/ISystem.h"
+#include "ChunkGenerator.h"
+#include <memory>
+#include <unordered_map>
+
+namespace engine {
+	// Keeps the chunks around the main camera loaded. Missing chunks are requested from
+	// the generator, nearest first, and chunks beyond the unload radius are dropped.
+	class WorldStreamingSystem : public ISystem {
+	public:
+		WorldStreamingSystem(uint32_t seed, std::filesystem::path cacheDirectory = "chunk_cache",
+			int loadMargin = 2, int unloadMargin = 4);
+
+		void update(Scene& scene) override;
+
+		// nullptr while the chunk is not loaded
+		const Chunk* chunk(ChunkCoord coord) const;
+		const std::unordered_map<ChunkCoord, std::unique_ptr<Chunk>, ChunkCoordHash>& loadedChunks() const { return m_chunks; }
+
+	private:
+		ChunkGenerator m_generator;
+		std::unordered_map<ChunkCoord, std::unique_ptr<Chunk>, ChunkCoordHash> m_chunks;
+		int m_loadMargin;     // Chunks kept around the viewport
+		int m_unloadMargin;   // Larger than the load margin so chunks at the border do not flicker
+	};
+}
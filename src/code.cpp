@@ -1,4 +1,5 @@
 #include "keygen.h"
+#include "randomr.h"
 #include <random>
 #include <stdexcept>
 #include <chrono>
@@ -22,8 +23,9 @@ namespace keygen {
 
 	const char* ULID_CHARS = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
 
-	static thread_local std::mt19937_64 gen{
-		std::random_device{}()
+	// Eigener Generator statt rnd::gen, Schlssel sollen nicht vom Replay-Seed abhngen
+	static thread_local rnd::Xoshiro256 gen{
+		(static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}()
 	};
 
 	// 2) Verteilungen als thread_local
@@ -68,10 +70,9 @@ namespace keygen {
 		return key;
 	}
 	std::string generateUniqueCode(std::size_t length) {
-		static thread_local std::mt19937_64 rng{
+		static thread_local rnd::Xoshiro256 rng{
 			std::random_device{}()
-			^ (std::mt19937_64::result_type)
-			  std::chrono::steady_clock::now().time_since_epoch().count()
+			^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())
 		};
 
 		std::uniform_int_distribution<> dist(0, allowed_chars.size() - 1);
@@ -4,6 +4,12 @@
 #include <thread>
 #include <iostream>
 #include "EngineMain.h"
+#include "SaveSystem.h"
+#include "InputRecorder.h"
+#include "Benchmarks.h"
+#include "WorldStreamingSystem.h"
+#include <optional>
+#include <cstdlib>
 #include "Experimental/FlappyBirdMainSystem.h"
 
 #pragma comment(lib, "Ws2_32.lib")
@@ -54,6 +60,36 @@ void parseCommand(const std::string& input) {
 			scene.addComponent<engine::BoxCollider>(handle);
 		}
 	}
+	else if (command == "capture") {
+		int frames;
+		if (!(iss >> frames) || frames <= 0) {
+			std::cout << "[ERROR] capture benötigt eine Anzahl Frames: capture <Frames> [Pfad]\n";
+			return;
+		}
+
+		std::string path = "profile_trace.json";
+		iss >> path;
+
+		std::cout << "[INFO] Zeichne " << frames << " Frames nach " << path << " auf\n";
+		engine::Profiler::Get().BeginCapture(static_cast<uint32_t>(frames), path);
+	}
+	else if (command == "save") {
+		std::string path = "scene.snapshot";
+		iss >> path;
+
+		// Läuft im Netzwerk-Thread, gespeichert wird beim nächsten Frame im Main-Thread
+		std::cout << "[INFO] Speichere Szene nach " << path << "\n";
+		engine::SaveSystem::requestSave(path);
+	}
+	else if (command == "bench") {
+		std::string name;
+		int amount = 200000;
+		iss >> name >> amount;
+		if (amount <= 0 || !engine::Benchmarks::run(name, amount)) {
+			std::cout << "[ERROR] bench benötigt einen Namen und eine positive Anzahl: bench <" << engine::Benchmarks::names() << "> [Anzahl]\n";
+			return;
+		}
+	}
 	else {
 		std::cout << "[WARNUNG] Unbekannter Befehl: " << command << "\n";
 	}
@@ -132,7 +168,7 @@ void StartNetworkHost()
 
 
 
-int main() {
+int main(int argc, char** argv) {
 	Window::init();
 	Window appWindow{ 800, 800, "2D Engine", engine::WindowMode::WINDOWED_MAXIMIZED };
 	Window::vsync(false);
@@ -148,11 +184,27 @@ int main() {
 		TextureManager::loadTexture("bluebird-midflap.png", FilterMode::None);
 		TextureManager::loadTexture("bluebird-upflap.png", FilterMode::None);
 
+		// --record <Datei> zeichnet die Eingaben auf, --replay <Datei> spielt sie ab und beendet danach.
+		// Vor dem Erstellen der Szene, damit rnd schon beim Aufbau den aufgezeichneten Seed hat.
+		// --world <Seed> streamt die prozedurale Welt um die Kamera
+		std::optional<uint32_t> worldSeed;
+		for (int i = 1; i + 1 < argc; ++i) {
+			const std::string arg = argv[i];
+			if (arg == "--record")
+				engine::InputRecorder::startRecording(argv[++i]);
+			else if (arg == "--replay")
+				engine::InputRecorder::startReplay(argv[++i], true);
+			else if (arg == "--world")
+				worldSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+
 		const std::string name = "Flappy Bird";
 		SceneManager::createScene(name);
 		Scene& scene = SceneManager::loadScene(name);
 		scene.addSystem<GizmosRenderSystem>();
 		scene.addSystem<FlappyBirdMainSystem>();
+		if (worldSeed)
+			scene.addSystem<engine::WorldStreamingSystem>(uint32_t{ *worldSeed });
 		application.run();
 	}
 	catch (std::runtime_error e)
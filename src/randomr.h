@@ -2,28 +2,185 @@
 #include <random>
 #include <type_traits>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string_view>
+#include <limits>
 
 namespace rnd {
-	static thread_local std::mt19937_64 gen(std::random_device{}());
+	inline uint64_t splitmix64(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	inline constexpr uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	// xoshiro256** (Blackman/Vigna). 32 Byte Zustand, deutlich schneller als mt19937_64 und
+	// erfllt UniformRandomBitGenerator, funktioniert also weiter mit den std-Distributionen
+	class Xoshiro256 {
+	public:
+		using result_type = uint64_t;
+
+		explicit Xoshiro256(uint64_t seed = 0x5EED) { this->seed(seed); }
+
+		void seed(uint64_t seed) {
+			// splitmix verteilt auch schlechte Seeds (0, 1, 2 ...) auf den ganzen Zustand
+			for (uint64_t& word : s) word = splitmix64(seed);
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		result_type operator()() {
+			const uint64_t result = rotl(s[1] * 5, 7) * 9;
+			const uint64_t t = s[1] << 17;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = rotl(s[3], 45);
+			return result;
+		}
+
+		// [0, 1) mit 24 Bit Auflsung, jeder Wert exakt als float darstellbar
+		float nextFloat() { return static_cast<float>((*this)() >> 40) * 0x1.0p-24f; }
+		double nextDouble() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+	private:
+		uint64_t s[4];
+	};
+
+	// Vier unabhngige xoshiro256** im SoA-Layout fr die Bulk-Funktionen. Die Schleifen
+	// ber die Lanes haben keine Abhngigkeiten und werden mit AVX2 zu einem Schritt
+	class Xoshiro256x4 {
+	public:
+		static constexpr int k_lanes = 4;
+
+		explicit Xoshiro256x4(uint64_t seed) {
+			for (int lane = 0; lane < k_lanes; ++lane)
+				for (int i = 0; i < 4; ++i)
+					s[i][lane] = splitmix64(seed);
+		}
+
+		void next(uint64_t out[k_lanes]) {
+			for (int lane = 0; lane < k_lanes; ++lane) {
+				out[lane] = rotl(s[1][lane] * 5, 7) * 9;
+				const uint64_t t = s[1][lane] << 17;
+				s[2][lane] ^= s[0][lane];
+				s[3][lane] ^= s[1][lane];
+				s[1][lane] ^= s[2][lane];
+				s[0][lane] ^= s[3][lane];
+				s[2][lane] ^= t;
+				s[3][lane] = rotl(s[3][lane], 45);
+			}
+		}
+
+	private:
+		alignas(32) uint64_t s[4][k_lanes];
+	};
 
-	inline void seed(long s) {
+	// Zuletzt gesetzter Seed, gilt prozessweit und ist die Basis aller benannten Streams
+	inline std::atomic<uint64_t> lastSeed{ (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}() };
+
+	// inline statt static, sonst hat jede bersetzungseinheit ihren eigenen Generator und seed() wirkt nur lokal
+	inline thread_local Xoshiro256 gen{ lastSeed.load(std::memory_order_relaxed) ^ std::random_device{}() };
+
+	// Setzt den Seed fr alle spter erzeugten Streams und den Generator des aufrufenden Threads
+	inline void seed(uint64_t s) {
+		lastSeed.store(s, std::memory_order_relaxed);
 		gen.seed(s);
 	}
 
+	inline constexpr uint64_t hashName(std::string_view name) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (char c : name) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	// Eigener, reproduzierbarer Generator pro System (und optional pro Job/Chunk/Frame).
+	// Gleicher Seed, Name und Index ergeben unabhngig vom Thread immer dieselbe Folge,
+	// parallele Jobs bleiben so deterministisch
+	inline Xoshiro256 stream(std::string_view name, uint64_t index = 0) {
+		uint64_t state = lastSeed.load(std::memory_order_relaxed) ^ hashName(name);
+		state ^= splitmix64(state) + index * 0xD1B54A32D192ED03ull;
+		return Xoshiro256{ splitmix64(state) };
+	}
+
+	template<typename T>
+	inline T next(Xoshiro256& g, T min, T max) {
+		if constexpr (std::is_floating_point_v<T>) {
+			// [min, max) wie uniform_real_distribution
+			if constexpr (std::is_same_v<T, float>) return min + g.nextFloat() * (max - min);
+			else return min + static_cast<T>(g.nextDouble()) * (max - min);
+		}
+		else if constexpr (sizeof(T) <= 4) {
+			// [min, max] wie uniform_int_distribution. Multiply-Shift statt Modulo, der Bias
+			// liegt bei hchstens range / 2^32
+			const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+			return static_cast<T>(static_cast<int64_t>(min) + static_cast<int64_t>(((g() >> 32) * range) >> 32));
+		}
+		else {
+			std::uniform_int_distribution<T> dist(min, max);
+			return dist(g);
+		}
+	}
+
 	template<typename T>
 	inline T next(T min, T max) {
-		// Whle zur Compile-Zeit die passende Distribution
-		using dist_t = std::conditional_t<
-			std::is_integral_v<T>,
-			std::uniform_int_distribution<T>,
-			std::uniform_real_distribution<T>
-		>;
+		return next(gen, min, max);
+	}
+
+	// Bulk-Varianten: deutlich schneller als count einzelne next()-Aufrufe. Die Folge hngt
+	// nur vom Generator ab, nicht vom Thread, der die Funktion aufruft
 
-		// Einmalige Erzeugung der Distribution pro Thread
-		static thread_local dist_t dist;
+	// count Werte in [min, max)
+	inline void fillUniform(Xoshiro256& g, float* out, size_t count, float min = 0.f, float max = 1.f) {
+		Xoshiro256x4 lanes{ g() };
+		const float scale = (max - min) * 0x1.0p-24f;
+		uint64_t bits[Xoshiro256x4::k_lanes];
+		size_t i = 0;
+		for (; i + Xoshiro256x4::k_lanes <= count; i += Xoshiro256x4::k_lanes) {
+			lanes.next(bits);
+			for (int lane = 0; lane < Xoshiro256x4::k_lanes; ++lane)
+				out[i + lane] = min + static_cast<float>(static_cast<uint32_t>(bits[lane] >> 40)) * scale;
+		}
+		for (; i < count; ++i)
+			out[i] = min + static_cast<float>(static_cast<uint32_t>(g() >> 40)) * scale;
+	}
+
+	// count Werte in [min, max]
+	inline void fillInt(Xoshiro256& g, int32_t* out, size_t count, int32_t min, int32_t max) {
+		Xoshiro256x4 lanes{ g() };
+		const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+		uint64_t bits[Xoshiro256x4::k_lanes];
+		size_t i = 0;
+		for (; i + Xoshiro256x4::k_lanes <= count; i += Xoshiro256x4::k_lanes) {
+			lanes.next(bits);
+			for (int lane = 0; lane < Xoshiro256x4::k_lanes; ++lane)
+				out[i + lane] = static_cast<int32_t>(static_cast<int64_t>(min) + static_cast<int64_t>(((bits[lane] >> 32) * range) >> 32));
+		}
+		for (; i < count; ++i)
+			out[i] = next(g, min, max);
+	}
 
-		// Nur die Parameter (min, max) neu setzen  minimaler Overhead
-		return dist(gen, typename dist_t::param_type(min, max));
+	// Rohe 64 Bit, z.B. fr eigene Verteilungen oder Hashes
+	inline void fillBits(Xoshiro256& g, uint64_t* out, size_t count) {
+		Xoshiro256x4 lanes{ g() };
+		size_t i = 0;
+		for (; i + Xoshiro256x4::k_lanes <= count; i += Xoshiro256x4::k_lanes)
+			lanes.next(out + i);
+		for (; i < count; ++i)
+			out[i] = g();
 	}
 
-}
\ No newline at end of file
+	inline void fillUniform(float* out, size_t count, float min = 0.f, float max = 1.f) { fillUniform(gen, out, count, min, max); }
+	inline void fillInt(int32_t* out, size_t count, int32_t min, int32_t max) { fillInt(gen, out, count, min, max); }
+}
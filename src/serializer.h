@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <array>
 #include <lz4.h>
+#include "JobSystem.h"
 
 #include <type_traits>
 #include <string>
@@ -13,8 +14,28 @@
 #
 #include <stdexcept>
 #include <cstring> 
+#include <span>
+#include <string_view>
+#include <cctype>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
 #define _CRT_SECURE_NO_WARNINGS
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using Json = nlohmann::json;
 
 namespace serializer {
@@ -502,6 +523,591 @@ namespace serializer {
 			std::fclose(f);
 			return obj;
 		}
+
+		enum class AccessPattern {
+			Normal,
+			Sequential,  // Aggressives Read-Ahead, gelesene Seiten drfen frh verworfen werden
+			Random,      // Kein Read-Ahead
+			WillNeed     // Ganze Datei sofort vorladen
+		};
+
+		// Read-only Memory-Mapping einer Datei. Die Seiten kommen direkt aus dem Page-Cache und
+		// werden zwischen Prozessen geteilt, die dieselbe Datei mappen.
+		class MappedFile {
+		public:
+			MappedFile() = default;
+			explicit MappedFile(const std::filesystem::path& filepath) { open(filepath); }
+			~MappedFile() { close(); }
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+			MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+			MappedFile& operator=(MappedFile&& other) noexcept {
+				if (this != &other) {
+					close();
+					data_ = std::exchange(other.data_, nullptr);
+					size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+					file_ = std::exchange(other.file_, INVALID_HANDLE_VALUE);
+					mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+				}
+				return *this;
+			}
+
+			void open(const std::filesystem::path& filepath) {
+				close();
+#ifdef _WIN32
+				file_ = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file_ == INVALID_HANDLE_VALUE)
+					throw std::runtime_error("Could not open file: " + filepath.string());
+
+				LARGE_INTEGER fileSize{};
+				GetFileSizeEx(file_, &fileSize);
+				size_ = static_cast<std::size_t>(fileSize.QuadPart);
+				if (size_ == 0) return;
+
+				mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (!mapping_) {
+					close();
+					throw std::runtime_error("CreateFileMapping failed: " + filepath.string());
+				}
+				data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+				if (!data_) {
+					close();
+					throw std::runtime_error("MapViewOfFile failed: " + filepath.string());
+				}
+#else
+				int fd = ::open(filepath.c_str(), O_RDONLY);
+				if (fd < 0)
+					throw std::runtime_error("Could not open file: " + filepath.string());
+
+				struct stat st {};
+				if (fstat(fd, &st) != 0) {
+					::close(fd);
+					throw std::runtime_error("fstat failed: " + filepath.string());
+				}
+				size_ = static_cast<std::size_t>(st.st_size);
+				if (size_ == 0) {
+					::close(fd);
+					return;
+				}
+
+				void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+				// Das Mapping hlt die Datei selbst offen
+				::close(fd);
+				if (mapped == MAP_FAILED) {
+					size_ = 0;
+					throw std::runtime_error("mmap failed: " + filepath.string());
+				}
+				data_ = static_cast<const char*>(mapped);
+#endif
+			}
+
+			void close() {
+#ifdef _WIN32
+				if (data_) UnmapViewOfFile(data_);
+				if (mapping_) CloseHandle(mapping_);
+				if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+				mapping_ = nullptr;
+				file_ = INVALID_HANDLE_VALUE;
+#else
+				if (data_) munmap(const_cast<char*>(data_), size_);
+#endif
+				data_ = nullptr;
+				size_ = 0;
+			}
+
+			// Nur ein Hinweis an das OS, Fehler werden ignoriert
+			void advise(AccessPattern pattern, std::size_t offset = 0, std::size_t length = SIZE_MAX) const {
+				if (!data_ || offset >= size_) return;
+				length = std::min(length, size_ - offset);
+#ifdef _WIN32
+				if (pattern == AccessPattern::Sequential || pattern == AccessPattern::WillNeed) {
+					WIN32_MEMORY_RANGE_ENTRY range{ const_cast<char*>(data_) + offset, length };
+					PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+				}
+#else
+				// madvise braucht eine seitenausgerichtete Startadresse
+				const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+				const std::size_t alignedOffset = offset - offset % page;
+				int advice = MADV_NORMAL;
+				switch (pattern) {
+				case AccessPattern::Sequential: advice = MADV_SEQUENTIAL; break;
+				case AccessPattern::Random:     advice = MADV_RANDOM; break;
+				case AccessPattern::WillNeed:   advice = MADV_WILLNEED; break;
+				default: break;
+				}
+				madvise(const_cast<char*>(data_) + alignedOffset, length + (offset - alignedOffset), advice);
+#endif
+			}
+
+			const char* data() const { return data_; }
+			std::size_t size() const { return size_; }
+			bool isOpen() const { return data_ != nullptr; }
+
+		private:
+			const char* data_ = nullptr;
+			std::size_t size_ = 0;
+#ifdef _WIN32
+			HANDLE file_ = INVALID_HANDLE_VALUE;
+			HANDLE mapping_ = nullptr;
+#endif
+		};
+
+		// Typisierte, read-only Sicht auf eine mit saveArray geschriebene Datei. Die Daten werden
+		// nicht kopiert, die Sicht bleibt gltig solange das MappedArray lebt.
+		template<typename T>
+		class MappedArray {
+			static_assert(std::is_trivially_copyable_v<T>,
+				"MappedArray supports only trivially copyable types");
+			// saveArray legt die Daten direkt hinter den 8 Byte Count, der Anfang des Mappings ist seitenausgerichtet
+			static_assert(alignof(T) <= alignof(uint64_t),
+				"saveArray stores elements at offset 8, over-aligned types cannot be mapped");
+
+		public:
+			MappedArray() = default;
+			explicit MappedArray(const std::filesystem::path& filepath, AccessPattern pattern = AccessPattern::Sequential)
+				: file_(filepath)
+			{
+				if (file_.size() < sizeof(uint64_t))
+					throw std::runtime_error("File too small for an array header: " + filepath.string());
+
+				uint64_t count = 0;
+				std::memcpy(&count, file_.data(), sizeof(count));
+				if (count > (file_.size() - sizeof(uint64_t)) / sizeof(T))
+					throw std::runtime_error("Array count exceeds file size: " + filepath.string());
+
+				const char* first = file_.data() + sizeof(uint64_t);
+				if (reinterpret_cast<std::uintptr_t>(first) % alignof(T) != 0)
+					throw std::runtime_error("Mapped array is misaligned: " + filepath.string());
+
+				data_ = reinterpret_cast<const T*>(first);
+				count_ = static_cast<std::size_t>(count);
+				file_.advise(pattern);
+			}
+
+			std::span<const T> span() const { return { data_, count_ }; }
+			const T* data() const { return data_; }
+			std::size_t size() const { return count_; }
+			bool empty() const { return count_ == 0; }
+			const T& operator[](std::size_t i) const { return data_[i]; }
+			const T* begin() const { return data_; }
+			const T* end() const { return data_ + count_; }
+
+			// Hinweis fr einen Teilbereich, z.B. WillNeed fr den als nchstes gelesenen Chunk
+			void advise(AccessPattern pattern, std::size_t first, std::size_t count) const {
+				file_.advise(pattern, sizeof(uint64_t) + first * sizeof(T), count * sizeof(T));
+			}
+
+		private:
+			MappedFile file_;
+			const T* data_ = nullptr;
+			std::size_t count_ = 0;
+		};
+
+		// Zero-Copy Gegenstck zu loadArray fr unkomprimierte Arrays
+		template<typename T>
+		MappedArray<T> mapArray(const std::filesystem::path& filepath, AccessPattern pattern = AccessPattern::Sequential) {
+			return MappedArray<T>(filepath, pattern);
+		}
+
+		// Chunked LZ4 Container: Header, Index, dann unabhngig komprimierte Blcke fester Gre.
+		// Blcke werden parallel (de)komprimiert und lassen sich einzeln lesen.
+		struct ChunkedHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t elementSize;
+			uint32_t reserved;
+			uint64_t rawSize;
+			uint64_t chunkSize;   // Rohgre eines Blocks in Bytes, der letzte kann kleiner sein
+			uint64_t chunkCount;
+		};
+
+		struct ChunkEntry {
+			uint64_t offset;
+			uint32_t storedSize;  // == rawSize: Block liegt unkomprimiert vor
+			uint32_t rawSize;
+		};
+
+		inline constexpr uint32_t k_chunkedMagic = 0x43345A4C; // "LZ4C"
+		inline constexpr uint32_t k_chunkedVersion = 1;
+		inline constexpr std::size_t k_defaultChunkBytes = 1 << 20;
+
+		template<typename T>
+		void saveArrayLZ4Chunked(const std::filesystem::path& filepath, const T* data, std::size_t count,
+			std::size_t chunkBytes = k_defaultChunkBytes)
+		{
+			static_assert(std::is_trivially_copyable_v<T>,
+				"saveArrayLZ4Chunked supports only trivially copyable types");
+
+			const std::size_t chunkElements = std::max<std::size_t>(1, std::min<std::size_t>(chunkBytes, LZ4_MAX_INPUT_SIZE) / sizeof(T));
+			const std::size_t chunkRaw = chunkElements * sizeof(T);
+			const std::size_t chunkCount = (count + chunkElements - 1) / chunkElements;
+			const char* src = reinterpret_cast<const char*>(data);
+
+			// --- 1) Datei ffnen (MSVC-sicher)
+			FILE* f = nullptr;
+#ifdef _MSC_VER
+			errno_t err = fopen_s(&f, filepath.string().c_str(), "wb");
+			if (err != 0 || !f)
+				throw std::runtime_error("fopen_s failed with code: " + std::to_string(err));
+#else
+			f = std::fopen(filepath.string().c_str(), "wb");
+			if (!f)
+				throw std::runtime_error("fopen failed");
+#endif
+			static constexpr std::size_t BUF_SZ = 1 << 20;
+			static thread_local std::unique_ptr<char[]> buf{ new char[BUF_SZ] };
+			std::setvbuf(f, buf.get(), _IOFBF, BUF_SZ);
+
+			// --- 2) Header und Platz fr den Index, der Index wird am Ende nachgetragen
+			const ChunkedHeader header{ k_chunkedMagic, k_chunkedVersion, static_cast<uint32_t>(sizeof(T)), 0,
+				static_cast<uint64_t>(count * sizeof(T)), static_cast<uint64_t>(chunkRaw), static_cast<uint64_t>(chunkCount) };
+			std::vector<ChunkEntry> index(chunkCount, ChunkEntry{ 0, 0, 0 });
+			if (std::fwrite(&header, sizeof(header), 1, f) != 1 ||
+				(chunkCount > 0 && std::fwrite(index.data(), sizeof(ChunkEntry), chunkCount, f) != chunkCount))
+			{
+				std::fclose(f);
+				throw std::runtime_error("fwrite(header) failed");
+			}
+
+			// --- 3) In Wellen komprimieren und schreiben, der Speicher bleibt bei wave * Blockgre
+			ThreadPool& pool = ThreadPool::global();
+			const std::size_t wave = std::min<std::size_t>(chunkCount, (pool.threadCount() + 1) * 2);
+			std::vector<std::vector<char>> compressed(wave);
+			std::vector<int> compressedSizes(wave);
+			uint64_t offset = sizeof(ChunkedHeader) + chunkCount * sizeof(ChunkEntry);
+
+			for (std::size_t first = 0; first < chunkCount; first += wave) {
+				const std::size_t n = std::min(wave, chunkCount - first);
+				pool.parallelFor(n, [&](std::size_t i) {
+					const std::size_t chunk = first + i;
+					const std::size_t rawSize = std::min(chunkRaw, count * sizeof(T) - chunk * chunkRaw);
+					compressed[i].resize(LZ4_compressBound(static_cast<int>(rawSize)));
+					compressedSizes[i] = LZ4_compress_default(src + chunk * chunkRaw, compressed[i].data(),
+						static_cast<int>(rawSize), static_cast<int>(compressed[i].size()));
+				});
+
+				for (std::size_t i = 0; i < n; ++i) {
+					const std::size_t chunk = first + i;
+					const uint32_t rawSize = static_cast<uint32_t>(std::min(chunkRaw, count * sizeof(T) - chunk * chunkRaw));
+					// Nicht komprimierbare Blcke roh ablegen
+					const bool keep = compressedSizes[i] > 0 && static_cast<uint32_t>(compressedSizes[i]) < rawSize;
+					const char* payload = keep ? compressed[i].data() : src + chunk * chunkRaw;
+					const uint32_t storedSize = keep ? static_cast<uint32_t>(compressedSizes[i]) : rawSize;
+
+					if (std::fwrite(payload, 1, storedSize, f) != storedSize) {
+						std::fclose(f);
+						throw std::runtime_error("fwrite(chunk) failed");
+					}
+					index[chunk] = ChunkEntry{ offset, storedSize, rawSize };
+					offset += storedSize;
+				}
+			}
+
+			// --- 4) Index nachtragen
+			if (chunkCount > 0) {
+				if (std::fseek(f, static_cast<long>(sizeof(ChunkedHeader)), SEEK_SET) != 0 ||
+					std::fwrite(index.data(), sizeof(ChunkEntry), chunkCount, f) != chunkCount)
+				{
+					std::fclose(f);
+					throw std::runtime_error("fwrite(index) failed");
+				}
+			}
+			std::fclose(f);
+		}
+
+		// Liest einen chunked LZ4 Container ber ein Memory-Mapping, dekomprimiert wird direkt
+		// in den Zielspeicher, ohne Zwischenpuffer fr die komprimierten Daten.
+		template<typename T>
+		class ChunkedArrayReader {
+			static_assert(std::is_trivially_copyable_v<T>,
+				"ChunkedArrayReader supports only trivially copyable types");
+
+		public:
+			explicit ChunkedArrayReader(const std::filesystem::path& filepath, AccessPattern pattern = AccessPattern::Normal)
+				: file_(filepath)
+			{
+				if (file_.size() < sizeof(ChunkedHeader))
+					throw std::runtime_error("File too small for a chunked header: " + filepath.string());
+				std::memcpy(&header_, file_.data(), sizeof(ChunkedHeader));
+
+				if (header_.magic != k_chunkedMagic || header_.version > k_chunkedVersion)
+					throw std::runtime_error("Not a chunked LZ4 file: " + filepath.string());
+				if (header_.elementSize != sizeof(T) || header_.chunkSize == 0 || header_.chunkSize % sizeof(T) != 0)
+					throw std::runtime_error("Element size mismatch in " + filepath.string());
+				if (header_.chunkCount > (file_.size() - sizeof(ChunkedHeader)) / sizeof(ChunkEntry))
+					throw std::runtime_error("Chunk index exceeds file size: " + filepath.string());
+
+				index_.resize(static_cast<std::size_t>(header_.chunkCount));
+				if (!index_.empty())
+					std::memcpy(index_.data(), file_.data() + sizeof(ChunkedHeader), index_.size() * sizeof(ChunkEntry));
+				// Nur der letzte Block darf kleiner sein, sonst wrde readAll ber das Ziel hinaus schreiben
+				uint64_t total = 0;
+				for (std::size_t i = 0; i < index_.size(); ++i) {
+					const ChunkEntry& entry = index_[i];
+					const bool sizeOk = i + 1 < index_.size() ? entry.rawSize == header_.chunkSize : entry.rawSize <= header_.chunkSize;
+					if (!sizeOk || entry.offset + entry.storedSize > file_.size())
+						throw std::runtime_error("Corrupt chunk index in " + filepath.string());
+					total += entry.rawSize;
+				}
+				if (total != header_.rawSize)
+					throw std::runtime_error("Corrupt chunk index in " + filepath.string());
+				file_.advise(pattern);
+			}
+
+			std::size_t size() const { return static_cast<std::size_t>(header_.rawSize / sizeof(T)); }
+			std::size_t chunkCount() const { return index_.size(); }
+			std::size_t chunkElements() const { return static_cast<std::size_t>(header_.chunkSize / sizeof(T)); }
+
+			// Dekomprimiert einen Block nach out (Platz fr chunkElements()), liefert die Anzahl Elemente
+			std::size_t readChunk(std::size_t chunk, T* out) const {
+				const ChunkEntry& entry = index_.at(chunk);
+				const char* src = file_.data() + entry.offset;
+				char* dst = reinterpret_cast<char*>(out);
+
+				if (entry.storedSize == entry.rawSize) {
+					std::memcpy(dst, src, entry.rawSize);
+				}
+				else {
+					int res = LZ4_decompress_safe(src, dst, static_cast<int>(entry.storedSize), static_cast<int>(entry.rawSize));
+					if (res < 0 || static_cast<uint32_t>(res) != entry.rawSize)
+						throw std::runtime_error("LZ4 decompression failed in chunk " + std::to_string(chunk));
+				}
+				return entry.rawSize / sizeof(T);
+			}
+
+			void readAll(std::vector<T>& out) const {
+				out.resize(size());
+				ThreadPool::global().parallelFor(index_.size(), [&](std::size_t chunk) {
+					readChunk(chunk, out.data() + chunk * chunkElements());
+				});
+			}
+
+			std::vector<T> readAll() const {
+				std::vector<T> out;
+				readAll(out);
+				return out;
+			}
+
+		private:
+			MappedFile file_;
+			ChunkedHeader header_{};
+			std::vector<ChunkEntry> index_;
+		};
+
+		template<typename T>
+		std::vector<T> loadArrayLZ4Chunked(const std::filesystem::path& filepath) {
+			return ChunkedArrayReader<T>(filepath, AccessPattern::Sequential).readAll();
+		}
+	}
+
+	// Streaming-Loader fr groe JSON-Dateien. Statt eines DOMs fr die ganze Datei wird immer nur
+	// ein Element eines Arrays aufgebaut und sofort nach T konvertiert. Die Loader brauchen den
+	// globalen mtx nicht, da sie keinen geteilten Zustand haben.
+	namespace json {
+		namespace detail {
+			// SAX-Handler, der jedes Element des Ziel-Arrays einzeln an onElement bergibt.
+			// Ziel ist das Array auf oberster Ebene oder, mit arrayKey, das Array unter diesem Key.
+			template<typename OnElement>
+			class ElementSax : public nlohmann::json_sax<Json> {
+			public:
+				ElementSax(OnElement& onElement, std::string_view arrayKey)
+					: onElement_(onElement), arrayKey_(arrayKey), targetDepth_(arrayKey.empty() ? 1 : 2) {}
+
+				bool null() override { return value(nullptr); }
+				bool boolean(bool val) override { return value(val); }
+				bool number_integer(number_integer_t val) override { return value(val); }
+				bool number_unsigned(number_unsigned_t val) override { return value(val); }
+				bool number_float(number_float_t val, const string_t&) override { return value(val); }
+				bool string(string_t& val) override { return value(std::move(val)); }
+				bool binary(binary_t& val) override { return value(Json::binary(std::move(val))); }
+
+				bool start_object(std::size_t) override { return startContainer(Json::object()); }
+				bool start_array(std::size_t) override {
+					if (stack_.empty() && depth_ + 1 == targetDepth_ && (arrayKey_.empty() || keyMatched_)) {
+						++depth_;
+						inTarget_ = true;
+						return true;
+					}
+					return startContainer(Json::array());
+				}
+
+				bool key(string_t& val) override {
+					if (!stack_.empty())
+						pendingKey_ = std::move(val);
+					else if (depth_ == 1)
+						keyMatched_ = val == arrayKey_;
+					return true;
+				}
+
+				bool end_object() override { return endContainer(); }
+				bool end_array() override {
+					if (stack_.empty() && inTarget_ && depth_ == targetDepth_)
+						inTarget_ = false;
+					return endContainer();
+				}
+
+				bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+					throw std::runtime_error("JSON parse error at byte " + std::to_string(position) + ": " + ex.what());
+				}
+
+			private:
+				bool collecting() const { return inTarget_ && depth_ == targetDepth_; }
+
+				template<typename V>
+				bool value(V&& val) {
+					if (!stack_.empty()) {
+						insert(Json(std::forward<V>(val)));
+					}
+					else if (collecting()) {
+						onElement_(Json(std::forward<V>(val)));
+					}
+					return true;
+				}
+
+				Json* insert(Json&& val) {
+					Json& parent = *stack_.back();
+					if (parent.is_array()) {
+						parent.push_back(std::move(val));
+						return &parent.back();
+					}
+					return &(parent[pendingKey_] = std::move(val));
+				}
+
+				bool startContainer(Json&& container) {
+					if (!stack_.empty()) {
+						stack_.push_back(insert(std::move(container)));
+					}
+					else if (collecting()) {
+						element_ = std::move(container);
+						stack_.push_back(&element_);
+					}
+					else {
+						++depth_;
+					}
+					return true;
+				}
+
+				bool endContainer() {
+					if (stack_.empty()) {
+						--depth_;
+						return true;
+					}
+					stack_.pop_back();
+					if (stack_.empty())
+						onElement_(std::move(element_));
+					return true;
+				}
+
+				OnElement& onElement_;
+				std::string_view arrayKey_;
+				int targetDepth_;
+				int depth_ = 0;
+				bool inTarget_ = false;
+				bool keyMatched_ = false;
+				std::vector<Json*> stack_;
+				Json element_;
+				std::string pendingKey_;
+			};
+
+			// Sucht die Grenzen der Elemente des Arrays auf oberster Ebene und teilt sie in
+			// Bereiche von etwa rangeBytes. Jeder Bereich ist eine Komma-getrennte Elementliste.
+			inline std::vector<std::pair<std::size_t, std::size_t>> splitTopLevelArray(const char* text, std::size_t size, std::size_t rangeBytes) {
+				std::size_t pos = 0;
+				while (pos < size && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+				if (pos == size || text[pos] != '[')
+					throw std::runtime_error("JSON-Inhalt ist kein Array");
+
+				std::vector<std::pair<std::size_t, std::size_t>> ranges;
+				std::size_t rangeStart = ++pos;
+				int depth = 0;
+				bool inString = false;
+				for (; pos < size; ++pos) {
+					const char c = text[pos];
+					if (inString) {
+						if (c == '\\') ++pos;
+						else if (c == '"') inString = false;
+						continue;
+					}
+					switch (c) {
+					case '"': inString = true; break;
+					case '[': case '{': ++depth; break;
+					case '}': --depth; break;
+					case ']':
+						if (depth == 0) {
+							ranges.emplace_back(rangeStart, pos);
+							return ranges;
+						}
+						--depth;
+						break;
+					case ',':
+						if (depth == 0 && pos - rangeStart >= rangeBytes) {
+							ranges.emplace_back(rangeStart, pos);
+							rangeStart = pos + 1;
+						}
+						break;
+					default: break;
+					}
+				}
+				throw std::runtime_error("JSON-Array ist nicht abgeschlossen");
+			}
+		}
+
+		// Ruft fn(Json&&) fr jedes Element auf, ohne die Datei komplett einzulesen
+		template<typename F>
+		void forEachElement(const std::filesystem::path& filepath, F&& fn, std::string_view arrayKey = {}) {
+			std::ifstream ifs(filepath, std::ios::binary);
+			if (!ifs.is_open())
+				throw std::runtime_error("Konnte Datei nicht ffnen: " + filepath.string());
+
+			detail::ElementSax<std::remove_reference_t<F>> sax(fn, arrayKey);
+			Json::sax_parse(ifs, &sax);
+		}
+
+		// Wie loadVector, der Speicherbedarf ist aber das Ergebnis plus ein Element statt eines DOMs der ganzen Datei
+		template<typename T>
+		std::vector<T> loadVectorStreaming(const std::filesystem::path& filepath, std::string_view arrayKey = {}) {
+			std::vector<T> out;
+			forEachElement(filepath, [&](Json&& element) {
+				out.push_back(element.get<T>());
+			}, arrayKey);
+			return out;
+		}
+
+		// Parst ein Array auf oberster Ebene parallel. Die Datei wird gemappt, in Bereiche von
+		// etwa rangeBytes geteilt und jeder Bereich auf einem Worker gestreamt.
+		template<typename T>
+		std::vector<T> loadVectorParallel(const std::filesystem::path& filepath, std::size_t rangeBytes = 4 << 20) {
+			binary::MappedFile file(filepath);
+			file.advise(binary::AccessPattern::Sequential);
+			const auto ranges = detail::splitTopLevelArray(file.data(), file.size(), rangeBytes);
+
+			std::vector<std::vector<T>> parts(ranges.size());
+			ThreadPool::global().parallelFor(ranges.size(), [&](std::size_t i) {
+				const auto [first, last] = ranges[i];
+				std::vector<T>& part = parts[i];
+				auto onElement = [&](Json&& element) { part.push_back(element.get<T>()); };
+				detail::ElementSax<decltype(onElement)> sax(onElement, {});
+
+				// Der Bereich ist eine Elementliste ohne Klammern
+				std::string text;
+				text.reserve(last - first + 2);
+				text += '[';
+				text.append(file.data() + first, last - first);
+				text += ']';
+				Json::sax_parse(text, &sax);
+			});
+
+			std::size_t total = 0;
+			for (const auto& part : parts) total += part.size();
+			std::vector<T> out;
+			out.reserve(total);
+			for (auto& part : parts)
+				out.insert(out.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+			return out;
+		}
 	}
 }
 namespace path {